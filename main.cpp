@@ -3,6 +3,8 @@
 #include <iostream>
 #include <cmath>
 #include <thread>
+#include <future>
+#include <cstring>
 #include <chrono>
 #include "src/window_utils.h"
 #include "src/shader_utils.h"
@@ -26,6 +28,25 @@ using json = nlohmann::json;
 #include "audio_capture.h"
 #include "src/audio_capture.h"
 #include "src/fft_utils.h"
+#include "src/geometry_cache.h"
+#include "src/shape_types.h"
+#include "src/mesh_library.h"
+#include "src/gpu_fractal.h"
+#include "src/visual_fractal_engine.h"
+#include "src/escape_time_pass.h"
+#include "src/sdf_shapes.h"
+#include "src/line_renderer.h"
+#include "src/shader_manager.h"
+#include "src/gpu_timer.h"
+#include "src/profiler.h"
+#include "src/flight_recorder.h"
+#include "src/smoothing.h"
+#include "src/modulation_matrix.h"
+#include "src/audio_analysis.h"
+#include "src/audio_recorder.h"
+#include "src/offline_analyzer.h"
+#include "src/latency_model.h"
+#include "src/instance_ring.h"
 
 // Helper to find the latest saved preset file
 static std::string findLatestPresetPath() {
@@ -66,7 +87,7 @@ static std::string findLatestPresetPath() {
     return std::string();
 }
 
-// Add shader sources - OPTIMIZED VERSION
+// Built-in copies of shaders/instanced.vert and .frag, used when the files are missing
 const char* vertexShaderSource = R"(
 #version 330 core
 layout(location = 0) in vec3 aPos;
@@ -74,6 +95,9 @@ layout(location = 1) in vec3 aColor;
 layout(location = 2) in vec2 aOffset;
 layout(location = 3) in float aAngle;
 layout(location = 4) in vec2 aScale;
+layout(location = 5) in vec4 aColorTop;   // per-instance corner colors (RGBA8)
+layout(location = 6) in vec4 aColorLeft;
+layout(location = 7) in vec4 aColorRight;
 out vec3 vColor;
 uniform float uAspect;
 uniform float uTime;
@@ -84,7 +108,8 @@ void main() {
     vec2 pos = rot * (aPos.xy * aScale) + aOffset;
     pos.x /= uAspect;
     gl_Position = vec4(pos, aPos.z, 1.0);
-    vColor = aColor;
+    // aColor holds the weights of the three corner colors baked into the mesh
+    vColor = aColor.x * aColorTop.rgb + aColor.y * aColorLeft.rgb + aColor.z * aColorRight.rgb;
 }
 )";
 
@@ -97,35 +122,61 @@ void main() {
 }
 )";
 
+// Main instanced program: loaded from shaders/, hot-reloaded, binary cached
+ShaderManager shaderManager;
+ShaderHandle mainShader;
+
+// GPU/CPU time per render pass (geometry, ImGui, present), read back frames later
+GpuTimer gpuTimer;
+
+// Last ~10 s of frame phases; a frame over budget dumps them to hitch_<fecha>.csv
+FlightRecorder flightRecorder;
+
 // OPTIMIZATION: Instanced rendering structures
 struct InstanceData {
     float offsetX, offsetY;
     float angle;
     float scaleX, scaleY;
+    uint32_t colorTop, colorLeft, colorRight; // packed RGBA8, see packColor
+    float lineWidth = 1.25f;                  // pixels, read only by the line renderer
 };
 
-// OPTIMIZATION: VBO caching system
-struct CachedVBO {
-    GLuint VAO = 0;
-    GLuint VBO = 0;
-    GLuint instanceVBO = 0;
-    int shapeType = -1;
-    float size = 0.0f;
-    float colors[9] = {0}; // 3 colors * 3 components
-    int nSegments = 0;
-    bool fractalMode = false;
-    float fractalDepth = 0.0f;
-    std::vector<InstanceData> instances;
-    bool dirty = true;
-};
+// Corner colors as mesh "colors": the baked vertex colors become blend weights
+float cornerWeights[9] = {1.0f, 0.0f, 0.0f,  0.0f, 1.0f, 0.0f,  0.0f, 0.0f, 1.0f};
+
+// RGBA8 in memory order, read by the shader as normalized unsigned bytes
+inline uint32_t packColor(float r, float g, float b, float a = 1.0f) {
+    auto byte = [](float v) { return (uint32_t)(std::max(0.0f, std::min(1.0f, v)) * 255.0f + 0.5f); };
+    return byte(r) | (byte(g) << 8) | (byte(b) << 16) | (byte(a) << 24);
+}
+
+// OPTIMIZATION: Global geometry cache (hashed keys, LRU under a memory budget).
+// Entries are referenced through generational handles that go stale on eviction.
+GeometryCache geometryCache;
+
+// OPTIMIZATION: Unit meshes of every base shape in one static VBO, built once
+MeshLibrary meshLibrary;
+
+// OPTIMIZATION: Fractals expanded on the GPU (IFS, one instance per tree node)
+GpuFractal gpuFractal;
+
+// Sierpinski / Koch built level by level into one shared buffer
+VisualFractalEngine fractalEngine;
+
+// OPTIMIZATION: Mandelbrot / Julia per pixel in a fullscreen pass, within a GPU time budget
+EscapeTimePass escapePass;
 
-// OPTIMIZATION: Global VBO cache
-std::vector<CachedVBO> vboCache;
-const int MAX_CACHED_VBOS = 10;
+// OPTIMIZATION: Triangles, squares and circles as one quad each with analytic AA
+SdfShapeRenderer sdfShapes;
+
+// OPTIMIZATION: Line shapes as screen-space quads with real width (no glLineWidth)
+LineRenderer lineRenderer;
 
 // OPTIMIZATION: Batch rendering
 const int MAX_INSTANCES_PER_BATCH = 1000;
 std::vector<InstanceData> instanceBuffer;
+// OPTIMIZATION: Instance data for every batch streams through one ring buffer
+InstanceRing instanceRing;
 
 // Límites para random
 struct RandomLimits {
@@ -401,8 +452,7 @@ void loadPreset(const char* filename,
     }
 }
 
-// Añadir tipo de figura línea
-enum ShapeType { SHAPE_TRIANGLE = 0, SHAPE_SQUARE, SHAPE_CIRCLE, SHAPE_LINE, SHAPE_LONG_LINES, SHAPE_COUNT };
+// Nombres de los tipos de figura (ShapeType en src/shape_types.h)
 const char* shapeNames[] = {"Triángulo", "Cuadrado", "Círculo", "Línea", "Líneas largas"};
 
 // Estructura de parámetros de un objeto visual
@@ -434,36 +484,29 @@ struct VisualGroup {
     float groupAngle = 0.0f;
 };
 
-// OPTIMIZATION: VBO caching functions
-CachedVBO* findOrCreateCachedVBO(int shapeType, float size, float colors[9], int nSegments, bool fractalMode, float fractalDepth) {
-    // Buscar VBO existente
-    for (auto& cached : vboCache) {
-        if (cached.shapeType == shapeType && 
-            cached.size == size && 
-            cached.nSegments == nSegments &&
-            cached.fractalMode == fractalMode &&
-            cached.fractalDepth == fractalDepth) {
-            bool colorsMatch = true;
-            for (int i = 0; i < 9; ++i) {
-                if (fabs(cached.colors[i] - colors[i]) > 0.001f) {
-                    colorsMatch = false;
-                    break;
-                }
-            }
-            if (colorsMatch) {
-                return &cached;
-            }
-        }
+// Atributos de instancia del VAO enlazado; los punteros se fijan en cada draw hacia el instanceRing
+void enableInstanceAttributes() {
+    glEnableVertexAttribArray(2); // offset
+    glVertexAttribDivisor(2, 1);
+    glEnableVertexAttribArray(3); // angle
+    glVertexAttribDivisor(3, 1);
+    glEnableVertexAttribArray(4); // scale
+    glVertexAttribDivisor(4, 1);
+    for (int a = 5; a <= 7; ++a) { // corner colors
+        glEnableVertexAttribArray(a);
+        glVertexAttribDivisor(a, 1);
     }
-    
-    // Crear nuevo VBO si no existe
-    if (vboCache.size() >= MAX_CACHED_VBOS) {
-        // Limpiar el VBO más antiguo
-        auto& oldest = vboCache[0];
-        if (oldest.VAO) glDeleteVertexArrays(1, &oldest.VAO);
-        if (oldest.VBO) glDeleteBuffers(1, &oldest.VBO);
-        if (oldest.instanceVBO) glDeleteBuffers(1, &oldest.instanceVBO);
-        vboCache.erase(vboCache.begin());
+    glEnableVertexAttribArray(8); // line width
+    glVertexAttribDivisor(8, 1);
+}
+
+// OPTIMIZATION: VBO caching functions
+GeometryHandle findOrCreateCachedVBO(int shapeType, float size, float colors[9], int nSegments, bool fractalMode, float fractalDepth, float time = 0.0f) {
+    // Buscar geometría existente
+    GeometryKey key = makeGeometryKey(shapeType, size, colors, nSegments, fractalMode, fractalDepth);
+    GeometryHandle found = geometryCache.find(key);
+    if (geometryCache.get(found)) {
+        return found;
     }
     
     CachedVBO newCached;
@@ -478,148 +521,362 @@ CachedVBO* findOrCreateCachedVBO(int shapeType, float size, float colors[9], int
     
     // Crear VAO y VBO
     if (fractalMode) {
-        createFractal(newCached.VAO, newCached.VBO, shapeType, size, colors, colors+3, colors+6, fractalDepth, 0.0f);
+        newCached.vertexCount = createFractal(newCached.VAO, newCached.VBO, shapeType, size, colors, colors+3, colors+6, fractalDepth, time);
+        newCached.primitive = fractalPrimitive(shapeType);
     } else {
-        createShape(newCached.VAO, newCached.VBO, shapeType, size, colors, colors+3, colors+6, nSegments);
+        createShape(newCached.VAO, newCached.VBO, shapeType, size, cornerWeights, cornerWeights+3, cornerWeights+6, nSegments);
     }
     
-    // Crear VBO para instancing
-    glGenBuffers(1, &newCached.instanceVBO);
     glBindVertexArray(newCached.VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, newCached.instanceVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(InstanceData) * MAX_INSTANCES_PER_BATCH, nullptr, GL_DYNAMIC_DRAW);
-    
-    // Configurar atributos de instancia
-    glEnableVertexAttribArray(2); // offset
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, offsetX));
-    glVertexAttribDivisor(2, 1);
-    
-    glEnableVertexAttribArray(3); // angle
-    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, angle));
-    glVertexAttribDivisor(3, 1);
-    
-    glEnableVertexAttribArray(4); // scale
-    glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, scaleX));
-    glVertexAttribDivisor(4, 1);
+    enableInstanceAttributes();
+    glBindVertexArray(0);
     
+    GLint bufferBytes = 0;
+    glBindBuffer(GL_ARRAY_BUFFER, newCached.VBO);
+    glGetBufferParameteriv(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &bufferBytes);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    newCached.bytes = (size_t)std::max(0, bufferBytes);
     
-    vboCache.push_back(newCached);
-    return &vboCache.back();
+    return geometryCache.insert(key, newCached);
 }
 
-// OPTIMIZATION: Batch rendering function
-void renderBatch(CachedVBO* cached, const std::vector<InstanceData>& instances, GLuint shaderProgram, float aspect) {
-    if (!cached || instances.empty()) return;
-    
-    // OPTIMIZATION: Set uniforms once per batch
+// Point the instance attributes of the bound VAO at `offset` in `buffer`
+void bindInstanceAttributes(GLuint buffer, size_t offset) {
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(offset + offsetof(InstanceData, offsetX)));
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(offset + offsetof(InstanceData, angle)));
+    glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(offset + offsetof(InstanceData, scaleX)));
+    glVertexAttribPointer(5, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(InstanceData), (void*)(offset + offsetof(InstanceData, colorTop)));
+    glVertexAttribPointer(6, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(InstanceData), (void*)(offset + offsetof(InstanceData, colorLeft)));
+    glVertexAttribPointer(7, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(InstanceData), (void*)(offset + offsetof(InstanceData, colorRight)));
+    glVertexAttribPointer(8, 1, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(offset + offsetof(InstanceData, lineWidth)));
+}
+
+// OPTIMIZATION: Set uniforms once per batch (locations cached by the shader manager)
+void setBatchUniforms(GLuint shaderProgram, float aspect) {
     glUseProgram(shaderProgram);
     static float lastAspect = -1.0f;
+    static float lastTimeUpdate = 0.0f;
+    // A reloaded program starts with default uniform values
+    static unsigned lastGeneration = 0;
+    if (lastGeneration != shaderManager.generation(mainShader)) {
+        lastGeneration = shaderManager.generation(mainShader);
+        lastAspect = -1.0f;
+        lastTimeUpdate = 0.0f;
+    }
     if (lastAspect != aspect) {
-        glUniform1f(glGetUniformLocation(shaderProgram, "uAspect"), aspect);
+        glUniform1f(shaderManager.uniform(mainShader, "uAspect"), aspect);
         lastAspect = aspect;
     }
     
     // OPTIMIZATION: Only update time uniform if needed (every 16ms for 60fps)
-    static float lastTimeUpdate = 0.0f;
     float currentTime = (float)glfwGetTime();
     if (currentTime - lastTimeUpdate > 0.016f) {
-        glUniform1f(glGetUniformLocation(shaderProgram, "uTime"), currentTime);
+        glUniform1f(shaderManager.uniform(mainShader, "uTime"), currentTime);
         lastTimeUpdate = currentTime;
     }
+}
+
+// Si dibujamos líneas, aplicar grosor y suavizado
+void setLineState() {
+    glEnable(GL_LINE_SMOOTH);
+    glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+    // Algunos drivers limitan ancho>1.0; usar 1.0-1.5 para consistencia
+    glLineWidth(1.25f);
+}
+
+// OPTIMIZATION: Batch rendering function
+void renderBatch(GLuint vao, const MeshRange& mesh, const std::vector<InstanceData>& instances, GLuint shaderProgram, float aspect) {
+    if (!vao || mesh.count <= 0 || instances.empty()) return;
+    
+    setBatchUniforms(shaderProgram, aspect);
+    glBindVertexArray(vao);
     
-    glBindVertexArray(cached->VAO);
+    // OPTIMIZATION: Write the whole batch into this frame's ring region (no driver
+    // copy or sync), then draw it with a single call
+    size_t bytes = sizeof(InstanceData) * instances.size();
+    size_t offset = 0;
+    void* dst = instanceRing.allocate(bytes, sizeof(InstanceData), offset);
+    if (!dst) {
+        glBindVertexArray(0);
+        return;
+    }
+    memcpy(dst, instances.data(), bytes);
+    instanceRing.commit();
+    bindInstanceAttributes(instanceRing.buffer(), offset);
+    GLsizei batchSize = (GLsizei)instances.size();
+
+    if (mesh.mode == GL_LINES || mesh.mode == GL_LINE_LOOP) setLineState();
     
-    // OPTIMIZATION: Render in larger batches for better GPU utilization
-    const int OPTIMAL_BATCH_SIZE = 500; // Increased from 1000 for better balance
+    // OPTIMIZATION: Use instanced rendering for all shapes
+    glDrawArraysInstanced(mesh.mode, mesh.first, mesh.count, batchSize);
     
-    for (size_t i = 0; i < instances.size(); i += OPTIMAL_BATCH_SIZE) {
-        size_t batchSize = std::min(OPTIMAL_BATCH_SIZE, (int)(instances.size() - i));
-        
-        // OPTIMIZATION: Use glBufferSubData more efficiently
-        glBindBuffer(GL_ARRAY_BUFFER, cached->instanceVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(InstanceData) * batchSize, &instances[i]);
-        
-        // OPTIMIZATION: Pre-calculate vertex counts
-        int vertexCount = 0;
-        if (cached->shapeType == 0) vertexCount = 3;
-        else if (cached->shapeType == 1) vertexCount = 4;
-        else if (cached->shapeType == 2) vertexCount = cached->nSegments + 2;
-        else if (cached->shapeType == 3) vertexCount = 2;
-        else if (cached->shapeType == 4) vertexCount = 12;
+    glBindVertexArray(0);
+}
+
+// OPTIMIZATION: Instances bucketed by library mesh. The buckets (and their
+// vectors) are reused across frames; only the first activeMeshBuckets are live.
+struct MeshBucket {
+    MeshRange mesh;
+    std::vector<InstanceData> instances;
+};
+std::vector<MeshBucket> meshBuckets;
+size_t activeMeshBuckets = 0;
+
+void addMeshInstance(const MeshRange& mesh, const InstanceData& instance) {
+    for (size_t b = 0; b < activeMeshBuckets; ++b) {
+        if (meshBuckets[b].mesh.first == mesh.first) {
+            meshBuckets[b].instances.push_back(instance);
+            return;
+        }
+    }
+    if (activeMeshBuckets == meshBuckets.size()) meshBuckets.emplace_back();
+    MeshBucket& bucket = meshBuckets[activeMeshBuckets++];
+    bucket.mesh = mesh;
+    bucket.instances.clear();
+    bucket.instances.push_back(instance);
+}
+
+// Layout of GL_DRAW_INDIRECT_BUFFER commands for glMultiDrawArraysIndirect
+struct DrawArraysIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint first;
+    GLuint baseInstance;
+};
+
+// OPTIMIZATION: Draws every bucket from the mesh library in a constant number
+// of GL calls: all instances go into one ring allocation, followed by one
+// indirect command per bucket, and each primitive (triangles, lines) is one
+// glMultiDrawArraysIndirect. Without multi-draw it issues one
+// glDrawArraysInstancedBaseInstance per bucket, and on plain GL 3.3 it rebinds
+// the instance attributes at each bucket's offset instead of using baseInstance.
+void renderMeshBuckets(GLuint shaderProgram, float aspect) {
+    size_t totalInstances = 0;
+    for (size_t b = 0; b < activeMeshBuckets; ++b) totalInstances += meshBuckets[b].instances.size();
+    if (totalInstances == 0 || !meshLibrary.vao()) {
+        activeMeshBuckets = 0;
+        return;
+    }
+    
+    static const bool hasBaseInstance = GLEW_VERSION_4_2 || GLEW_ARB_base_instance;
+    static const bool hasMultiDraw = hasBaseInstance && (GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect);
+    
+    // Triangles first, then lines, so each primitive is one contiguous run of commands
+    static std::vector<DrawArraysIndirectCommand> commands;
+    static std::vector<size_t> commandBucket;
+    commands.clear();
+    commandBucket.clear();
+    size_t lineStart = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        GLenum mode = pass == 0 ? GL_TRIANGLES : GL_LINES;
+        if (pass == 1) lineStart = commands.size();
+        for (size_t b = 0; b < activeMeshBuckets; ++b) {
+            if (meshBuckets[b].mesh.mode != mode) continue;
+            DrawArraysIndirectCommand cmd;
+            cmd.count = (GLuint)meshBuckets[b].mesh.count;
+            cmd.instanceCount = (GLuint)meshBuckets[b].instances.size();
+            cmd.first = (GLuint)meshBuckets[b].mesh.first;
+            cmd.baseInstance = 0; // set in upload order below
+            commands.push_back(cmd);
+            commandBucket.push_back(b);
+        }
+    }
+    
+    // One allocation for instances + commands, so a ring growth can't split them
+    size_t instanceBytes = totalInstances * sizeof(InstanceData);
+    size_t commandBytes = hasMultiDraw ? commands.size() * sizeof(DrawArraysIndirectCommand) : 0;
+    size_t offset = 0;
+    char* dst = (char*)instanceRing.allocate(instanceBytes + commandBytes, sizeof(InstanceData), offset);
+    if (!dst) {
+        activeMeshBuckets = 0;
+        return;
+    }
+    GLuint base = 0;
+    for (size_t c = 0; c < commands.size(); ++c) {
+        const std::vector<InstanceData>& instances = meshBuckets[commandBucket[c]].instances;
+        memcpy(dst + base * sizeof(InstanceData), instances.data(), instances.size() * sizeof(InstanceData));
+        commands[c].baseInstance = base;
+        base += commands[c].instanceCount;
+    }
+    if (hasMultiDraw) memcpy(dst + instanceBytes, commands.data(), commandBytes);
+    instanceRing.commit();
+    
+    setBatchUniforms(shaderProgram, aspect);
+    glBindVertexArray(meshLibrary.vao());
+    bindInstanceAttributes(instanceRing.buffer(), offset);
+    
+    for (int pass = 0; pass < 2; ++pass) {
+        size_t begin = pass == 0 ? 0 : lineStart;
+        size_t end = pass == 0 ? lineStart : commands.size();
+        if (begin == end) continue;
+        GLenum mode = pass == 0 ? GL_TRIANGLES : GL_LINES;
+        if (mode == GL_LINES) setLineState();
         
-        // OPTIMIZATION: Use instanced rendering for all shapes
-        if (cached->fractalMode) {
-            glDrawArraysInstanced(GL_TRIANGLES, 0, 3000, batchSize);
+        if (hasMultiDraw) {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, instanceRing.buffer());
+            size_t commandOffset = offset + instanceBytes + begin * sizeof(DrawArraysIndirectCommand);
+            glMultiDrawArraysIndirect(mode, (const void*)commandOffset, (GLsizei)(end - begin), 0);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
         } else {
-            GLenum drawMode = GL_TRIANGLES;
-            if (cached->shapeType == 1) drawMode = GL_TRIANGLE_STRIP;
-            else if (cached->shapeType == 2) drawMode = GL_TRIANGLE_FAN;
-            else if (cached->shapeType == 3 || cached->shapeType == 4) drawMode = GL_LINES;
-            
-            // Si dibujamos líneas, aplicar grosor y suavizado
-            if (drawMode == GL_LINES) {
-                glEnable(GL_LINE_SMOOTH);
-                glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
-                // Algunos drivers limitan ancho>1.0; usar 1.0-1.5 para consistencia
-                glLineWidth(1.25f);
+            for (size_t c = begin; c < end; ++c) {
+                const DrawArraysIndirectCommand& cmd = commands[c];
+                if (hasBaseInstance) {
+                    glDrawArraysInstancedBaseInstance(mode, cmd.first, cmd.count, cmd.instanceCount, cmd.baseInstance);
+                } else {
+                    bindInstanceAttributes(instanceRing.buffer(), offset + cmd.baseInstance * sizeof(InstanceData));
+                    glDrawArraysInstanced(mode, cmd.first, cmd.count, cmd.instanceCount);
+                }
             }
-            
-            glDrawArraysInstanced(drawMode, 0, vertexCount, batchSize);
         }
     }
     
     glBindVertexArray(0);
+    activeMeshBuckets = 0;
+}
+
+// OPTIMIZATION: SDF shapes and thick lines bucketed by shape (and polygon
+// sides), one instanced quad draw per bucket; reused across frames like meshBuckets
+struct QuadBucket {
+    int shapeType;
+    int nSegments;
+    std::vector<InstanceData> instances;
+};
+std::vector<QuadBucket> quadBuckets;
+size_t activeQuadBuckets = 0;
+
+void addQuadInstance(int shapeType, int nSegments, const InstanceData& instance) {
+    // Circles only differ when they are drawn as polygons
+    if (shapeType != SHAPE_CIRCLE || nSegments > SdfShapeRenderer::MAX_POLYGON_SIDES) nSegments = 0;
+    for (size_t b = 0; b < activeQuadBuckets; ++b) {
+        if (quadBuckets[b].shapeType == shapeType && quadBuckets[b].nSegments == nSegments) {
+            quadBuckets[b].instances.push_back(instance);
+            return;
+        }
+    }
+    if (activeQuadBuckets == quadBuckets.size()) quadBuckets.emplace_back();
+    QuadBucket& bucket = quadBuckets[activeQuadBuckets++];
+    bucket.shapeType = shapeType;
+    bucket.nSegments = nSegments;
+    bucket.instances.clear();
+    bucket.instances.push_back(instance);
+}
+
+// All buckets share one ring allocation; each is one instanced quad draw.
+// Coverage comes from the distance to the shape, so MSAA is off while they draw.
+void renderQuadBuckets(int viewportWidth, int viewportHeight, float stroke) {
+    float aspect = (float)viewportWidth / (float)viewportHeight;
+    size_t totalInstances = 0;
+    for (size_t b = 0; b < activeQuadBuckets; ++b) totalInstances += quadBuckets[b].instances.size();
+    if (totalInstances == 0) {
+        activeQuadBuckets = 0;
+        return;
+    }
+    size_t offset = 0;
+    char* dst = (char*)instanceRing.allocate(totalInstances * sizeof(InstanceData), sizeof(InstanceData), offset);
+    if (!dst) {
+        activeQuadBuckets = 0;
+        return;
+    }
+    size_t base = 0;
+    for (size_t b = 0; b < activeQuadBuckets; ++b) {
+        const std::vector<InstanceData>& instances = quadBuckets[b].instances;
+        memcpy(dst + base * sizeof(InstanceData), instances.data(), instances.size() * sizeof(InstanceData));
+        base += instances.size();
+    }
+    instanceRing.commit();
+    
+    glDisable(GL_MULTISAMPLE);
+    base = 0;
+    for (size_t b = 0; b < activeQuadBuckets; ++b) {
+        const QuadBucket& bucket = quadBuckets[b];
+        GLsizei count = (GLsizei)bucket.instances.size();
+        if (LineRenderer::supports(bucket.shapeType)) {
+            lineRenderer.bind(bucket.shapeType, aspect, viewportWidth, viewportHeight);
+            bindInstanceAttributes(instanceRing.buffer(), offset + base * sizeof(InstanceData));
+            lineRenderer.draw(count);
+        } else {
+            sdfShapes.bind(bucket.shapeType, bucket.nSegments, stroke, aspect);
+            bindInstanceAttributes(instanceRing.buffer(), offset + base * sizeof(InstanceData));
+            sdfShapes.draw(count);
+        }
+        base += bucket.instances.size();
+    }
+    glEnable(GL_MULTISAMPLE);
+    activeQuadBuckets = 0;
 }
 
 // OPTIMIZATION: Pre-allocate instance buffer
 void prepareInstanceBuffer() {
     instanceBuffer.reserve(MAX_INSTANCES_PER_BATCH * 3); // Para 3 grupos
+    // Triple buffer con espacio para un frame típico por región (crece si hace falta)
+    instanceRing.init(sizeof(InstanceData) * MAX_INSTANCES_PER_BATCH * 3);
+    
+    // Las figuras base se generan una sola vez; el tamaño llega por la escala de instancia
+    meshLibrary.init();
+    glBindVertexArray(meshLibrary.vao());
+    enableInstanceAttributes();
+    glBindVertexArray(0);
+    gpuFractal.init();
+    fractalEngine.initialize();
+    glBindVertexArray(fractalEngine.vao());
+    enableInstanceAttributes();
+    glBindVertexArray(0);
+    escapePass.init();
+    sdfShapes.init();
+    lineRenderer.init();
 }
 
-// AUDIO REACTIVE SYSTEM: Advanced control structures
-struct AudioReactiveControl {
-    bool enabled = false;
-    float sensitivity = 1.0f;
-    float minValue = 0.0f;
-    float maxValue = 1.0f;
-    float smoothing = 0.1f;
-    float currentValue = 0.0f;
-    float targetValue = 0.0f;
-};
-
+// AUDIO REACTIVE SYSTEM: Per-group settings; the routing itself lives in modMatrix
 struct AudioReactiveGroup {
-    // Frequency ranges
-    AudioReactiveControl bass;      // 20-150 Hz
-    AudioReactiveControl lowMid;    // 150-400 Hz
-    AudioReactiveControl mid;       // 400-2000 Hz
-    AudioReactiveControl highMid;   // 2000-6000 Hz
-    AudioReactiveControl treble;    // 6000-20000 Hz
-    
-    // Parameters that can be controlled
-    AudioReactiveControl size;
-    AudioReactiveControl rotation;
-    AudioReactiveControl angle;
-    AudioReactiveControl translateX;
-    AudioReactiveControl translateY;
-    AudioReactiveControl scaleX;
-    AudioReactiveControl scaleY;
-    AudioReactiveControl colorIntensity;
-    AudioReactiveControl groupAngle;
-    AudioReactiveControl numObjects;
-    
-    // Mix presets
-    bool useBassMix = false;
-    bool useMidMix = false;
-    bool useTrebleMix = false;
-    bool useFullSpectrumMix = false;
+    // Smoothing time constants (seconds), independent of FPS
+    float attackTime = 0.03f;
+    float releaseTime = 0.25f;
+    bool springSmoothing = false;
 };
 
 // Audio reactive groups for each visual group
 AudioReactiveGroup audioGroups[3]; // 0: center, 1: right, 2: left
 
+// AUDIO REACTIVE SYSTEM: Modulation matrix, any analysis feature -> any parameter
+ModulationMatrix modMatrix;
+const int AUDIO_MOD_SLOTS = 3 * MOD_DST_COUNT; // slot = group * MOD_DST_COUNT + dest
+float modSources[MOD_SRC_COUNT] = {};
+float modTargets[AUDIO_MOD_SLOTS] = {};
+uint8_t modActive[AUDIO_MOD_SLOTS] = {};
+
+// AUDIO REACTIVE SYSTEM: Smoothed destination values, updated in one pass per frame
+SmoothingBank audioSmoothing;
+
+// Source each destination used before the matrix existed
+const ModSource defaultModSources[MOD_DST_COUNT] = {
+    MOD_SRC_OVERALL, MOD_SRC_MID, MOD_SRC_TREBLE, MOD_SRC_BASS, MOD_SRC_MID, MOD_SRC_TREBLE,
+    MOD_SRC_BASS, MOD_SRC_OVERALL, MOD_SRC_HIGH_MID, MOD_SRC_MID, MOD_SRC_BASS, MOD_SRC_PITCH
+};
+
+// One disabled route per destination and group, like the old fixed controls
+void initModRoutes() {
+    modMatrix.clear();
+    for (int g = 0; g < 3; ++g) {
+        for (int d = 0; d < MOD_DST_COUNT; ++d) {
+            const ModDestInfo& info = modDestInfo(d);
+            modMatrix.addRoute(g, defaultModSources[d], (ModDest)d, 1.0f, info.defaultMin, info.defaultMax,
+                               MOD_CURVE_LINEAR, false);
+        }
+    }
+}
+
+void initAudioSmoothing() {
+    if (audioSmoothing.size() > 0) return;
+    for (int g = 0; g < 3; ++g) {
+        for (int d = 0; d < MOD_DST_COUNT; ++d) {
+            audioSmoothing.add(modDestInfo(d).defaultMin, audioGroups[g].attackTime, audioGroups[g].releaseTime);
+        }
+    }
+}
+
 // Audio reactive presets
+// enabledControls/sensitivities: 0-4 bands, 5-13 size..groupAngle (see applyAudioPreset)
 struct AudioPreset {
     std::string name;
     std::vector<bool> enabledControls;
@@ -654,207 +911,111 @@ std::vector<AudioPreset> audioPresets = {
      {true,true,true,true,true}}
 };
 
-// Audio analysis variables
-struct AudioAnalysis {
-    float bass = 0.0f;
-    float lowMid = 0.0f;
-    float mid = 0.0f;
-    float highMid = 0.0f;
-    float treble = 0.0f;
-    float overall = 0.0f;
-    float peak = 0.0f;
-    float rms = 0.0f;
-};
-
 AudioAnalysis currentAudio;
+AudioFeatureExtractor audioFeatures;
 
-// AUDIO REACTIVE SYSTEM: Advanced audio analysis
-void analyzeAudioSpectrum(const std::vector<float>& spectrum, AudioAnalysis& analysis) {
-    if (spectrum.empty()) {
-        // Reset analysis to safe values
-        analysis.bass = 0.0f;
-        analysis.lowMid = 0.0f;
-        analysis.mid = 0.0f;
-        analysis.highMid = 0.0f;
-        analysis.treble = 0.0f;
-        analysis.overall = 0.0f;
-        analysis.peak = 0.0f;
-        analysis.rms = 0.0f;
-        return;
-    }
-    
-    int n = spectrum.size();
-    if (n <= 0) return;
-    
-    float sampleRate = 48000.0f;
-    float freqPerBin = sampleRate / (2.0f * n);
-    
-    // Prevent division by zero
-    if (freqPerBin <= 0.0f) freqPerBin = 1.0f;
-    
-    // Frequency ranges with safety checks
-    int bassStart = std::max(0, (int)(20.0f / freqPerBin));
-    int bassEnd = std::min(n - 1, (int)(150.0f / freqPerBin));
-    int lowMidStart = std::max(bassEnd, (int)(150.0f / freqPerBin));
-    int lowMidEnd = std::min(n - 1, (int)(400.0f / freqPerBin));
-    int midStart = std::max(lowMidEnd, (int)(400.0f / freqPerBin));
-    int midEnd = std::min(n - 1, (int)(2000.0f / freqPerBin));
-    int highMidStart = std::max(midEnd, (int)(2000.0f / freqPerBin));
-    int highMidEnd = std::min(n - 1, (int)(6000.0f / freqPerBin));
-    int trebleStart = std::max(highMidEnd, (int)(6000.0f / freqPerBin));
-    int trebleEnd = std::min(n - 1, (int)(20000.0f / freqPerBin));
-    
-    // Ensure valid ranges
-    bassStart = std::max(0, std::min(n-1, bassStart));
-    bassEnd = std::max(bassStart, std::min(n-1, bassEnd));
-    lowMidStart = std::max(bassEnd, std::min(n-1, lowMidStart));
-    lowMidEnd = std::max(lowMidStart, std::min(n-1, lowMidEnd));
-    midStart = std::max(lowMidEnd, std::min(n-1, midStart));
-    midEnd = std::max(midStart, std::min(n-1, midEnd));
-    highMidStart = std::max(midEnd, std::min(n-1, highMidStart));
-    highMidEnd = std::max(highMidStart, std::min(n-1, highMidEnd));
-    trebleStart = std::max(highMidEnd, std::min(n-1, trebleStart));
-    trebleEnd = std::max(trebleStart, std::min(n-1, trebleEnd));
-    
-    // Calculate averages for each frequency range
-    float bassSum = 0.0f, lowMidSum = 0.0f, midSum = 0.0f, highMidSum = 0.0f, trebleSum = 0.0f;
-    float overallSum = 0.0f;
-    float peakValue = 0.0f;
+// AUDIO REACTIVE SYSTEM: Translate a preset into routes for group g
+// Preset entries 5-13 become routes from the default source of each destination;
+// the old frequency mix boosts are folded into the route sensitivity.
+void applyAudioPreset(int g, const AudioPreset& preset) {
+    const ModDest presetDests[] = {
+        MOD_DST_SIZE, MOD_DST_ROTATION, MOD_DST_ANGLE, MOD_DST_TRANSLATE_X, MOD_DST_TRANSLATE_Y,
+        MOD_DST_SCALE_X, MOD_DST_SCALE_Y, MOD_DST_COLOR_INTENSITY, MOD_DST_GROUP_ANGLE
+    };
+    bool fullMix = preset.frequencyMixes[0] && preset.frequencyMixes[1] && 
+                   preset.frequencyMixes[2] && preset.frequencyMixes[3] && 
+                   preset.frequencyMixes[4];
     
-    for (int i = 0; i < n; ++i) {
-        float value = spectrum[i];
-        // Check for NaN or infinite values
-        if (std::isnan(value) || std::isinf(value)) {
-            value = 0.0f;
+    for (int k = 0; k < 9; ++k) {
+        ModDest dst = presetDests[k];
+        ModSource src = defaultModSources[dst];
+        
+        // Keep the range the user set for this destination
+        float minValue = modDestInfo(dst).defaultMin;
+        float maxValue = modDestInfo(dst).defaultMax;
+        int existing = modMatrix.findRoute(g, dst);
+        if (existing >= 0) {
+            minValue = modMatrix.minValue[existing];
+            maxValue = modMatrix.maxValue[existing];
         }
         
-        overallSum += value;
-        peakValue = std::max(peakValue, value);
+        float sensitivity = preset.sensitivities[5 + k];
+        if (src == MOD_SRC_BASS && preset.frequencyMixes[0]) sensitivity *= 2.0f;   // Boost bass
+        if (src == MOD_SRC_MID && preset.frequencyMixes[2]) sensitivity *= 2.0f;    // Boost mid
+        if (src == MOD_SRC_TREBLE && preset.frequencyMixes[4]) sensitivity *= 2.0f; // Boost treble
+        if (src == MOD_SRC_OVERALL && fullMix) sensitivity *= 1.5f;                 // Boost overall
         
-        if (i >= bassStart && i <= bassEnd) bassSum += value;
-        if (i >= lowMidStart && i <= lowMidEnd) lowMidSum += value;
-        if (i >= midStart && i <= midEnd) midSum += value;
-        if (i >= highMidStart && i <= highMidEnd) highMidSum += value;
-        if (i >= trebleStart && i <= trebleEnd) trebleSum += value;
-    }
-    
-    // Normalize by range size with safety checks
-    int bassCount = std::max(1, bassEnd - bassStart + 1);
-    int lowMidCount = std::max(1, lowMidEnd - lowMidStart + 1);
-    int midCount = std::max(1, midEnd - midStart + 1);
-    int highMidCount = std::max(1, highMidEnd - highMidStart + 1);
-    int trebleCount = std::max(1, trebleEnd - trebleStart + 1);
-    
-    analysis.bass = bassSum / bassCount;
-    analysis.lowMid = lowMidSum / lowMidCount;
-    analysis.mid = midSum / midCount;
-    analysis.highMid = highMidSum / highMidCount;
-    analysis.treble = trebleSum / trebleCount;
-    analysis.overall = overallSum / n;
-    analysis.peak = peakValue;
-    
-    // Safe RMS calculation
-    if (overallSum > 0.0f && n > 0) {
-        analysis.rms = sqrt(overallSum / n);
-    } else {
-        analysis.rms = 0.0f;
+        modMatrix.removeRoutes(g, dst);
+        modMatrix.addRoute(g, src, dst, sensitivity, minValue, maxValue, MOD_CURVE_LINEAR,
+                           preset.enabledControls[5 + k]);
     }
-    
-    // Final safety check for NaN values
-    if (std::isnan(analysis.bass)) analysis.bass = 0.0f;
-    if (std::isnan(analysis.lowMid)) analysis.lowMid = 0.0f;
-    if (std::isnan(analysis.mid)) analysis.mid = 0.0f;
-    if (std::isnan(analysis.highMid)) analysis.highMid = 0.0f;
-    if (std::isnan(analysis.treble)) analysis.treble = 0.0f;
-    if (std::isnan(analysis.overall)) analysis.overall = 0.0f;
-    if (std::isnan(analysis.peak)) analysis.peak = 0.0f;
-    if (std::isnan(analysis.rms)) analysis.rms = 0.0f;
 }
 
-// AUDIO REACTIVE SYSTEM: Apply audio control to parameters
-void applyAudioControl(AudioReactiveControl& control, float audioValue, float deltaTime) {
-    if (!control.enabled) return;
-    
-    // Safety checks for input values
-    if (std::isnan(audioValue) || std::isinf(audioValue)) {
-        audioValue = 0.0f;
+// AUDIO REACTIVE SYSTEM: Write the smoothed destinations of group g into its objects
+void applyAudioModulation(VisualGroup& group, int g) {
+    const float DEG_TO_RAD = 3.14159265f / 180.0f;
+    const uint8_t* active = &modActive[g * MOD_DST_COUNT];
+    float value[MOD_DST_COUNT];
+    for (int d = 0; d < MOD_DST_COUNT; ++d) {
+        const ModDestInfo& info = modDestInfo(d);
+        int slot = g * MOD_DST_COUNT + d;
+        float v = audioSmoothing.value(slot);
+        if (!std::isfinite(v)) {
+            v = info.defaultMin;
+            audioSmoothing.snap(slot, v);
+        }
+        value[d] = std::max(info.clampMin, std::min(info.clampMax, v));
     }
     
-    // Prevent division by zero or very small deltaTime
-    if (deltaTime <= 0.001f) {
-        deltaTime = 0.016f; // Use 60fps as fallback
+    // Group-level destinations first so the object count is known
+    if (active[MOD_DST_GROUP_ANGLE]) group.groupAngle = value[MOD_DST_GROUP_ANGLE] * DEG_TO_RAD;
+    if (active[MOD_DST_NUM_OBJECTS]) group.numObjects = (int)value[MOD_DST_NUM_OBJECTS];
+    if (group.objects.size() < static_cast<size_t>(group.numObjects)) {
+        group.objects.resize(group.numObjects);
+        group.targets.resize(group.numObjects);
     }
     
-    // Clamp audio value to reasonable range
-    audioValue = std::max(0.0f, std::min(10.0f, audioValue));
-    
-    // Apply sensitivity and range
-    float targetValue = control.minValue + (control.maxValue - control.minValue) * 
-                       (audioValue * control.sensitivity);
+    // Float members of VisualObjectParams in ModDest order (MOD_DST_SIZE..MOD_DST_SCALE_Y)
+    static float VisualObjectParams::* const objectFields[] = {
+        &VisualObjectParams::triSize, &VisualObjectParams::rotationSpeed, &VisualObjectParams::angle,
+        &VisualObjectParams::translateX, &VisualObjectParams::translateY,
+        &VisualObjectParams::scaleX, &VisualObjectParams::scaleY
+    };
+    static const float objectFieldScale[] = {1.0f, 1.0f, DEG_TO_RAD, 1.0f, 1.0f, 1.0f, 1.0f};
     
-    // Safety check for target value
-    if (std::isnan(targetValue) || std::isinf(targetValue)) {
-        targetValue = control.minValue;
+    const int n = group.numObjects;
+    for (int d = 0; d <= MOD_DST_SCALE_Y; ++d) {
+        if (!active[d]) continue;
+        float v = value[d] * objectFieldScale[d];
+        float VisualObjectParams::* field = objectFields[d];
+        for (int i = 0; i < n; ++i) group.objects[i].*field = v;
     }
-    
-    // Smooth transition with safety checks
-    control.targetValue = targetValue;
-    float smoothingFactor = control.smoothing / deltaTime;
-    
-    // Clamp smoothing factor to prevent instability
-    smoothingFactor = std::max(0.001f, std::min(1.0f, smoothingFactor));
-    
-    control.currentValue += (control.targetValue - control.currentValue) * smoothingFactor;
-    
-    // Final safety check for current value
-    if (std::isnan(control.currentValue) || std::isinf(control.currentValue)) {
-        control.currentValue = control.minValue;
+    if (active[MOD_DST_COLOR_INTENSITY]) {
+        float intensity = value[MOD_DST_COLOR_INTENSITY];
+        for (int i = 0; i < n; ++i) {
+            ImVec4& c = group.objects[i].colorTop;
+            c.x = std::min(1.0f, c.x * intensity);
+            c.y = std::min(1.0f, c.y * intensity);
+            c.z = std::min(1.0f, c.z * intensity);
+        }
+    }
+    if (active[MOD_DST_SEGMENTS]) {
+        int segments = (int)lroundf(value[MOD_DST_SEGMENTS]);
+        for (int i = 0; i < n; ++i) group.objects[i].nSegments = segments;
+    }
+    if (active[MOD_DST_HUE]) {
+        // Absolute hue, saturation and value of each color are kept
+        float hue = value[MOD_DST_HUE] / 360.0f;
+        hue -= floorf(hue);
+        for (int i = 0; i < n; ++i) {
+            ImVec4* colors[3] = {&group.objects[i].colorTop, &group.objects[i].colorLeft, &group.objects[i].colorRight};
+            for (ImVec4* c : colors) {
+                float h, sat, val;
+                ImGui::ColorConvertRGBtoHSV(c->x, c->y, c->z, h, sat, val);
+                ImGui::ColorConvertHSVtoRGB(hue, sat, val, c->x, c->y, c->z);
+            }
+        }
     }
-}
-
-// AUDIO REACTIVE SYSTEM: Apply preset to audio group
-void applyAudioPreset(AudioReactiveGroup& group, const AudioPreset& preset) {
-    // Apply frequency mix settings
-    group.useBassMix = preset.frequencyMixes[0];
-    group.useMidMix = preset.frequencyMixes[2];
-    group.useTrebleMix = preset.frequencyMixes[4];
-    group.useFullSpectrumMix = preset.frequencyMixes[0] && preset.frequencyMixes[1] && 
-                               preset.frequencyMixes[2] && preset.frequencyMixes[3] && 
-                               preset.frequencyMixes[4];
-    
-    // Apply control settings
-    group.bass.enabled = preset.enabledControls[0];
-    group.lowMid.enabled = preset.enabledControls[1];
-    group.mid.enabled = preset.enabledControls[2];
-    group.highMid.enabled = preset.enabledControls[3];
-    group.treble.enabled = preset.enabledControls[4];
-    
-    group.size.enabled = preset.enabledControls[5];
-    group.rotation.enabled = preset.enabledControls[6];
-    group.angle.enabled = preset.enabledControls[7];
-    group.translateX.enabled = preset.enabledControls[8];
-    group.translateY.enabled = preset.enabledControls[9];
-    group.scaleX.enabled = preset.enabledControls[10];
-    group.scaleY.enabled = preset.enabledControls[11];
-    group.colorIntensity.enabled = preset.enabledControls[12];
-    group.groupAngle.enabled = preset.enabledControls[13];
-    
-    // Apply sensitivities
-    group.bass.sensitivity = preset.sensitivities[0];
-    group.lowMid.sensitivity = preset.sensitivities[1];
-    group.mid.sensitivity = preset.sensitivities[2];
-    group.highMid.sensitivity = preset.sensitivities[3];
-    group.treble.sensitivity = preset.sensitivities[4];
-    
-    group.size.sensitivity = preset.sensitivities[5];
-    group.rotation.sensitivity = preset.sensitivities[6];
-    group.angle.sensitivity = preset.sensitivities[7];
-    group.translateX.sensitivity = preset.sensitivities[8];
-    group.translateY.sensitivity = preset.sensitivities[9];
-    group.scaleX.sensitivity = preset.sensitivities[10];
-    group.scaleY.sensitivity = preset.sensitivities[11];
-    group.colorIntensity.sensitivity = preset.sensitivities[12];
-    group.groupAngle.sensitivity = preset.sensitivities[13];
 }
 
 // UI VISIBILITY CONTROL SYSTEM
@@ -1385,7 +1546,6 @@ int main() {
 
     // OPTIMIZATION: Initialize VBO caching system
     prepareInstanceBuffer();
-    vboCache.reserve(MAX_CACHED_VBOS);
 
     // Dear ImGui: setup
     IMGUI_CHECKVERSION();
@@ -1436,19 +1596,20 @@ int main() {
     int shapeType = 0;
     // Declare randomLimits
     RandomLimits randomLimits;
-    GLuint shaderProgram = createShaderProgram(vertexShaderSource, fragmentShaderSource);
+    shaderManager.init();
+    mainShader = shaderManager.load("instanced", "shaders/instanced.vert", "shaders/instanced.frag",
+                                    vertexShaderSource, fragmentShaderSource);
+    GLuint shaderProgram = shaderManager.program(mainShader);
+    gpuTimer.init();
+    bool showTimingOverlay = true;
     
     // OPTIMIZATION: Remove old VAO/VBO variables - now using caching system
     float colorTopArr[3] = {colorTop.x, colorTop.y, colorTop.z};
     float colorLeftArr[3] = {colorLeft.x, colorLeft.y, colorLeft.z};
     float colorRightArr[3] = {colorRight.x, colorRight.y, colorRight.z};
-    int actualSegments = (shapeType == 0) ? 3 : (shapeType == 1) ? 4 : 128;
     
-    // OPTIMIZATION: Initialize first cached VBO
-    float colors[9] = {colorTopArr[0], colorTopArr[1], colorTopArr[2],
-                      colorLeftArr[0], colorLeftArr[1], colorLeftArr[2],
-                      colorRightArr[0], colorRightArr[1], colorRightArr[2]};
-    CachedVBO* currentCachedVBO = findOrCreateCachedVBO(shapeType, triSize, colors, actualSegments, false, 0.0f);
+    // OPTIMIZATION: Only fractals live in the geometry cache; base shapes come from meshLibrary
+    GeometryHandle currentGeometry;
 
     int numTriangles = 1;
 
@@ -1457,6 +1618,15 @@ int main() {
     bool onlyRGB = false;
     bool fractalMode = false;
     float fractalDepth = 3.0f;
+    bool fractalOnGpu = true; // si no, geometría en CPU (caché de geometría)
+    int fractalKind = 0;        // 0: IFS de la figura, 1: Sierpinski, 2: Koch, 3: Mandelbrot, 4: Julia
+    bool sdfShapesEnabled = true;   // triángulos, cuadrados y círculos como campos de distancia
+    bool outlineOnly = false;       // solo bordes (requiere SDF)
+    float outlineWidth = 0.08f;     // grosor del borde relativo al tamaño de la figura
+    bool thickLines = true;         // líneas como quads con grosor real
+    float lineWidthPx = 2.0f;       // grosor base de las líneas en píxeles
+    float lineWidthAudio = 3.0f;    // píxeles extra con la banda del grupo al máximo
+    float fractalAudioDepth = 0.0f; // niveles extra con el audio al máximo
 
     // Al iniciar el programa, intenta cargar el último preset guardado
     {
@@ -1476,6 +1646,7 @@ int main() {
         groups[g].objects.resize(MAX_OBJECTS);
         groups[g].targets.resize(MAX_OBJECTS);
     }
+    initModRoutes();
 
     // Default startup preset: single centered triangle
     // Ensure exactly one object in the center and none on sides
@@ -1516,6 +1687,13 @@ int main() {
     static bool randomizeOnlyLines = false;
     static bool randomizeOnlyCylinders = false;
     static float randomizeVariation[3] = {0.5f, 0.8f, 0.6f}; // Variación en los intervalos
+    
+    // Suavizado independiente del FPS (slots 0-2: numObjects, 3: separación,
+    // 4-6: figura, 7-9: segmentos). Los enteros se suavizan como float y se redondean al leerlos
+    static SmoothingBank randomSmoothing;
+    const int RANDOM_SLOT_SEPARATION = 3;
+    const int RANDOM_SLOT_SHAPE = 4;
+    const int RANDOM_SLOT_SEGMENTS = 7;
 
     // --- NUEVO: Modo Fractal Toggle ---
     static bool fractalToggleMode = false;
@@ -1537,13 +1715,15 @@ int main() {
     static float glitchScaleY = 1.0f;
 
     // --- NUEVO: Randomización basada en frecuencias de música ---
+    // Disparada por golpes de batería (kick -> bass, snare -> mid, hi-hat -> treble)
     static bool frequencyBasedRandomization = false;
-    static float bassRandomizationThreshold = 0.3f;
-    static float midRandomizationThreshold = 0.4f;
-    static float trebleRandomizationThreshold = 0.5f;
-    static float lastBassRandomizeTime = 0.0f;
-    static float lastMidRandomizeTime = 0.0f;
-    static float lastTrebleRandomizeTime = 0.0f;
+    static float kickVelocityThreshold = 0.3f;
+    static float snareVelocityThreshold = 0.3f;
+    static float hatVelocityThreshold = 0.3f;
+    static float drumSensitivity = 1.0f;
+    static float lastKickRandomizeTime = 0.0f;
+    static float lastSnareRandomizeTime = 0.0f;
+    static float lastHatRandomizeTime = 0.0f;
     static float frequencyRandomizeCooldown = 0.5f; // Cooldown entre randomizaciones por frecuencia
 
     // 1. Parámetro de separación de grupos
@@ -1562,6 +1742,33 @@ int main() {
     const char* audioDevice = "default"; // Use default device instead of specific one
     const int audioSampleRate = 48000;
     const int audioChannels = 2;
+    static int pitchHop = 512; // muestras entre análisis de pitch
+    
+    // Grabación y reproducción de la línea de tiempo de análisis (.vcar)
+    static AudioRecorder audioRecorder;
+    static AudioReplay audioReplay;
+    static bool audioReplayActive = false;
+    static bool replayLockstep = false; // un frame grabado por frame renderizado
+    static double replayStartTime = 0.0;
+    static size_t replayFrame = 0;
+    static double replayClock = 0.0;   // tiempo grabado acumulado en lockstep
+    const unsigned int REPLAY_SEED = 12345;
+    static double recordStartTime = 0.0;
+    static char replayPath[256] = "";
+    
+    // Pista pre-analizada (análisis offline no causal, caché .vcan junto al WAV)
+    static OfflineAnalysis offlineTrack;
+    static OfflineAnalysis offlineJobResult; // escrito por el hilo de análisis
+    static std::future<bool> offlineJob;
+    static char offlineTrackPath[256] = "";
+    static bool offlineTrackSynced = false;
+    static double offlineTrackStart = 0.0;
+    
+    // Compensación de latencia: eventos de beat evaluados en el tiempo de pantalla
+    static LatencyModel latencyModel;
+    static BeatScheduler beatClock;
+    static bool beatPhaseLock = false;   // corregir la fase del beat con el bombo
+    static bool randomizeOnBeat = false; // disparar la randomización en el beat
 
     // Obtener lista de monitores de audio al inicio
     audioMonitors = get_monitor_sources();
@@ -1571,7 +1778,18 @@ int main() {
     selectedMonitor = 0;
     prevSelectedMonitor = 0;
 
+    profiler::setThreadName("Principal");
+    // Las pausas buscadas (límite de FPS, efecto glitch) no cuentan como hitch
+    flightRecorder.setIdlePhase("Pausa FPS");
+    flightRecorder.setIdlePhase("Pausa glitch");
     while (!glfwWindowShouldClose(window)) {
+        // PROFILER: fases consecutivas del frame (cada next() cierra la anterior)
+        ProfilePhases framePhases;
+        framePhases.next("Entrada y beat");
+        // Hot reload: edited shader files are swapped in once compiled
+        shaderManager.poll(glfwGetTime());
+        shaderProgram = shaderManager.program(mainShader);
+        gpuTimer.beginFrame();
         if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
             glfwSetWindowShouldClose(window, true);
         }
@@ -1606,17 +1824,32 @@ int main() {
         }
         
         float currentTime = glfwGetTime();
+        float frameStartTime = currentTime; // reloj real, para medir latencias
         float deltaTime = currentTime - lastTime;
         lastTime = currentTime;
 
+        // Lockstep: la animación avanza con los timestamps grabados y una semilla fija,
+        // así la misma grabación produce los mismos frames
+        bool lockstepReplay = audioReactive && audioReplayActive && replayLockstep &&
+                              audioReplay.isOpen() && audioReplay.frames() > 0;
+        if (lockstepReplay) {
+            if (replayFrame == 0) {
+                replayClock = 0.0;
+                srand(REPLAY_SEED);
+                for (int g = 0; g < 3; ++g) lastRandomizeTime[g] = (float)replayStartTime;
+            }
+            deltaTime = audioReplay.frameDelta(replayFrame % audioReplay.frames());
+            replayClock += deltaTime;
+            currentTime = (float)(replayStartTime + replayClock);
+        }
+
         // Modo rendimiento: minimizar trabajo por frame
         if (performanceMode) {
             // Forzar ilimitado y sin VSync
             if (fpsMode != FPS_UNLIMITED) {
                 fpsMode = FPS_UNLIMITED;
             }
-            // Desactivar características costosas
-            audioReactive = false;
+            // Desactivar características costosas (el audio reactivo pasa a bandas Goertzel)
             randomize = false;
             glitchEffectEnabled = false;
             fractalMode = false;
@@ -1632,7 +1865,24 @@ int main() {
         }
 
         // --- BPM y fase de beat ---
-        float beatPhase = fmod(currentTime * bpm / 60.0f, 1.0f); // 0..1
+        // Evaluado en el instante en que este frame llega a pantalla (modelo de latencia)
+        double displayTime = currentTime + latencyModel.visualLead();
+        double beatPosition;
+        // Cambiar de fuente de beat salta la posición: no disparar un beat por el salto
+        bool gridBeatSource = offlineTrackSynced && !offlineTrack.empty();
+        static bool prevGridBeatSource = false;
+        if (gridBeatSource != prevGridBeatSource) beatClock.restart();
+        prevGridBeatSource = gridBeatSource;
+        if (gridBeatSource) {
+            // Rejilla de beats de la pista pre-analizada (el BPM del usuario no se toca)
+            beatPosition = offlineTrack.beatPositionAt(displayTime - offlineTrackStart);
+        } else {
+            beatClock.setTempo(bpm, displayTime);
+            beatPosition = beatClock.beatPosition(displayTime);
+        }
+        float beatPhase = (float)(beatPosition - std::floor(beatPosition)); // 0..1
+        bool beatTriggered = beatClock.advance(beatPosition);
+        float beatPulse = beatClock.pulse(beatPosition);
 
         // Aplicar onlyRGB si está activo (antes de la animación de color)
         if (onlyRGB) {
@@ -1645,6 +1895,7 @@ int main() {
             }
         }
 
+        framePhases.next("UI");
         // Start ImGui frame (omitir si modo rendimiento)
         if (!performanceMode) {
             ImGui_ImplOpenGL3_NewFrame();
@@ -1668,6 +1919,12 @@ int main() {
             ImGui::SliderFloat("Velocidad de rotación (°/s)", &groups[0].objects[0].rotationSpeed, 10.0f, 720.0f, "%.1f");
             ImGui::SliderFloat("BPM", &bpm, 30.0f, 300.0f, "%.1f");
             ImGui::Text("Beat phase: %.2f", beatPhase);
+            ImGui::SameLine();
+            if (ImGui::Button("Tap beat")) {
+                // Pulsar al oír un beat: el tap llega con el sonido, sin latencia de análisis
+                beatClock.setReference(currentTime);
+            }
+            ImGui::Checkbox("Fase desde bombo", &beatPhaseLock);
             const char* fpsModes[] = { "VSync", "Ilimitado", "Custom" };
             ImGui::Combo("FPS Mode", &fpsMode, fpsModes, IM_ARRAYSIZE(fpsModes));
             if (fpsMode == FPS_CUSTOM) {
@@ -1675,6 +1932,35 @@ int main() {
             }
             ImGui::Text("ESC para salir | H para ocultar/mostrar UI");
             ImGui::Text("FPS(UI): %.1f", ImGui::GetIO().Framerate);
+            ImGui::Text("Caché geometría: %zu entradas, %.1f KB", geometryCache.size(), geometryCache.bytes() / 1024.0f);
+            ImGui::Text("Shaders: %s, %zu recargas", shaderManager.loadedFromBinary(mainShader) ? "binario en caché" : "compilados",
+                        shaderManager.reloadCount());
+            ImGui::Checkbox("Tiempos por pasada", &showTimingOverlay);
+            ImGui::SameLine();
+            bool logTimings = gpuTimer.csvActive();
+            if (ImGui::Checkbox("Registrar CSV", &logTimings)) {
+                if (logTimings) gpuTimer.startCsv("gpu_timings.csv");
+                else gpuTimer.stopCsv();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Exportar JSON")) gpuTimer.writeJson("gpu_timings.json");
+            bool profiling = profiler::enabled();
+            if (ImGui::Checkbox("Perfilador CPU (zonas)", &profiling)) profiler::setEnabled(profiling);
+            ImGui::Checkbox("Grabador de hitches", &flightRecorder.enabled);
+            if (flightRecorder.enabled) {
+                ImGui::SliderFloat("Presupuesto de frame (ms)", &flightRecorder.budgetMs, 20.0f, 500.0f, "%.0f");
+                ImGui::SliderFloat("Pausa entre volcados (s)", &flightRecorder.cooldownSeconds, 0.0f, 300.0f, "%.0f");
+                ImGui::Text("Peor frame: %.1f ms | volcados: %zu", flightRecorder.worstFrameMs(), flightRecorder.dumpCount());
+                if (flightRecorder.dumpCount() > 0) ImGui::Text("Último: %s", flightRecorder.lastDumpPath().c_str());
+            }
+            if (ImGui::Button("Volcar últimos 10 s")) flightRecorder.dump("volcado manual");
+            ImGui::SameLine();
+            if (ImGui::Button("Exportar traza Chrome")) {
+                char tracePath[64];
+                std::time_t t = std::time(nullptr);
+                std::strftime(tracePath, sizeof(tracePath), "trace_%Y%m%d_%H%M%S.json", std::localtime(&t));
+                profiler::writeChromeTrace(tracePath);
+            }
             ImGui::Checkbox("Modo Rendimiento (ultra)", &performanceMode);
             ImGui::Separator();
             // Opciones Globales
@@ -1762,6 +2048,18 @@ int main() {
         ImGui::Separator();
         ImGui::Checkbox("Animar color", &animateColor);
         ImGui::Checkbox("Solo colores RGB puros", &onlyRGB);
+        ImGui::Checkbox("Figuras SDF (bordes suaves sin MSAA)", &sdfShapesEnabled);
+        if (sdfShapesEnabled) {
+            if (!sdfShapes.ready()) ImGui::TextDisabled("(shader SDF no disponible, usando mallas)");
+            ImGui::Checkbox("Solo bordes", &outlineOnly);
+            if (outlineOnly) ImGui::SliderFloat("Grosor de borde", &outlineWidth, 0.01f, 0.3f, "%.2f");
+        }
+        ImGui::Checkbox("Líneas gruesas suavizadas", &thickLines);
+        if (thickLines) {
+            if (!lineRenderer.ready()) ImGui::TextDisabled("(shader de líneas no disponible, usando GL_LINES)");
+            ImGui::SliderFloat("Grosor de línea (px)", &lineWidthPx, 0.5f, 12.0f, "%.1f");
+            ImGui::SliderFloat("Grosor por audio (px)", &lineWidthAudio, 0.0f, 12.0f, "%.1f");
+        }
         ImGui::Separator();
         
         // AUDIO-DRIVEN RANDOMIZATION INFO
@@ -1775,7 +2073,27 @@ int main() {
         ImGui::Text("=== MODO FRACTAL ===");
         ImGui::Checkbox("Modo Fractal", &fractalMode);
         if (fractalMode) {
-            ImGui::SliderFloat("Profundidad Fractal", &fractalDepth, 1.0f, 5.0f, "%.1f");
+            ImGui::SliderFloat("Profundidad Fractal", &fractalDepth, 1.0f, (float)GpuFractal::MAX_LEVELS, "%.1f");
+            const char* fractalKinds[] = {"Figura (IFS)", "Sierpinski", "Copo de Koch", "Mandelbrot", "Julia"};
+            ImGui::Combo("Tipo de fractal", &fractalKind, fractalKinds, IM_ARRAYSIZE(fractalKinds));
+            if (fractalKind == 0) {
+                ImGui::Checkbox("Fractal en GPU", &fractalOnGpu);
+                if (!gpuFractal.ready()) ImGui::TextDisabled("(shader fractal no disponible, usando CPU)");
+            } else if (fractalKind >= 3) {
+                if (!escapePass.ready()) ImGui::TextDisabled("(shader Mandelbrot/Julia no disponible)");
+                ImGui::Checkbox("Iteraciones adaptativas", &escapePass.adaptive);
+                ImGui::SliderFloat("Presupuesto GPU (ms)", &escapePass.targetMs, 1.0f, 16.0f, "%.1f");
+                ImGui::SliderInt("Iteraciones máximas", &escapePass.maxIterations, 64, 2048);
+                ImGui::Checkbox("Resolución automática", &escapePass.autoResolution);
+                if (!escapePass.autoResolution)
+                    ImGui::SliderFloat("Escala de resolución", &escapePass.resolutionScale, 0.25f, 1.0f, "%.2f");
+                ImGui::Text("Iteraciones: %d, resolución %.0f%%, GPU %.2f ms",
+                            escapePass.iterations(), escapePass.scale() * 100.0f, escapePass.gpuMs());
+            } else {
+                ImGui::SliderFloat("Profundidad por audio", &fractalAudioDepth, 0.0f, 4.0f, "%.1f niveles");
+                ImGui::Text("Niveles construidos: %d (actual %d)",
+                            fractalEngine.builtLevels(fractalEngine.getFractalType()), fractalEngine.getCurrentDepth());
+            }
             ImGui::Text("Crea fractales animados y coloridos");
             ImGui::Text("basados en la figura seleccionada");
             ImGui::Text("✅ Todas las figuras son compatibles con fractales");
@@ -1809,13 +2127,14 @@ int main() {
         ImGui::Text("=== RANDOMIZACIÓN POR FRECUENCIAS ===");
         ImGui::Checkbox("Randomización por Frecuencias", &frequencyBasedRandomization);
         if (frequencyBasedRandomization) {
-            ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "🎵 Randomización basada en frecuencias de música");
-            ImGui::SliderFloat("Umbral Bass", &bassRandomizationThreshold, 0.1f, 0.8f, "%.2f");
-            ImGui::SliderFloat("Umbral Mid", &midRandomizationThreshold, 0.1f, 0.8f, "%.2f");
-            ImGui::SliderFloat("Umbral Treble", &trebleRandomizationThreshold, 0.1f, 0.8f, "%.2f");
+            ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "🎵 Randomización disparada por kick / snare / hi-hat");
+            ImGui::SliderFloat("Sensibilidad batería", &drumSensitivity, 0.25f, 4.0f, "%.2f");
+            ImGui::SliderFloat("Umbral Kick", &kickVelocityThreshold, 0.0f, 1.0f, "%.2f");
+            ImGui::SliderFloat("Umbral Snare", &snareVelocityThreshold, 0.0f, 1.0f, "%.2f");
+            ImGui::SliderFloat("Umbral Hi-hat", &hatVelocityThreshold, 0.0f, 1.0f, "%.2f");
             ImGui::SliderFloat("Cooldown (segundos)", &frequencyRandomizeCooldown, 0.1f, 2.0f, "%.1f");
-            ImGui::Text("Bass: %.2f | Mid: %.2f | Treble: %.2f", 
-                       currentAudio.bass, currentAudio.mid, currentAudio.treble);
+            ImGui::Text("Kick: %.2f | Snare: %.2f | Hi-hat: %.2f", 
+                       currentAudio.drum[DRUM_KICK], currentAudio.drum[DRUM_SNARE], currentAudio.drum[DRUM_HAT]);
         }
         
         ImGui::Separator();
@@ -1913,13 +2232,16 @@ int main() {
         ImGui::SliderFloat("Suavidad randomización", &randomLerpSpeed, 0.001f, 0.2f, "%.3f");
         ImGui::SliderFloat("Frecuencia base", &randomizeIntervals[0], 0.5f, 10.0f, "%.1f");
         ImGui::Text("(Intervalo base para todos los grupos)");
+        ImGui::Checkbox("Randomizar en el beat", &randomizeOnBeat);
         ImGui::Separator();
         
         // --- NUEVO: Semilla de randomización ---
         static int randomSeedMode = 0; // 0 = hora actual, 1 = audio
         const char* seedModes[] = {"Semilla: Hora actual", "Semilla: Audio del sistema"};
         ImGui::Combo("Modo de semilla", &randomSeedMode, seedModes, IM_ARRAYSIZE(seedModes));
-        if (randomSeedMode == 0) {
+        if (lockstepReplay) {
+            // La semilla fija de la reproducción lockstep no se toca
+        } else if (randomSeedMode == 0) {
             // Semilla por hora actual
             srand((unsigned int)time(nullptr));
         } else {
@@ -2051,10 +2373,112 @@ int main() {
             ImGui::Text("Análisis: Bass: %.3f | Mid: %.3f | Treble: %.3f | Peak: %.3f", 
                        currentAudio.bass, currentAudio.mid, currentAudio.treble, currentAudio.peak);
             ImGui::Text("RMS: %.3f | Overall: %.3f", currentAudio.rms, currentAudio.overall);
+            ImGui::Text("Pitch: %.1f Hz | MIDI %.1f | Confianza %.2f | %.3f ms/hop",
+                       currentAudio.pitchHz, currentAudio.pitchMidi, currentAudio.pitchConfidence,
+                       audio ? audio->getPitchAnalysisMs() : 0.0f);
+            ImGui::SliderInt("Hop Pitch (muestras)", &pitchHop, 128, 2048);
+            ImGui::Text("Centroide: %.3f | Planitud: %.3f | Rolloff: %.3f | Flujo: %.3f | ZCR: %.3f",
+                       currentAudio.centroid, currentAudio.flatness, currentAudio.rolloff,
+                       currentAudio.flux, currentAudio.zcr);
+            ImGui::Text("Envolventes: B %.3f | LM %.3f | M %.3f | HM %.3f | T %.3f",
+                       currentAudio.envelopePeak[0], currentAudio.envelopePeak[1], currentAudio.envelopePeak[2],
+                       currentAudio.envelopePeak[3], currentAudio.envelopePeak[4]);
         } else if (audioReactive) {
             ImGui::Text("⚠️ No hay datos de audio disponibles");
         }
         
+        // Grabación / reproducción determinista del análisis
+        ImGui::Separator();
+        ImGui::Text("📼 Grabación de Análisis:");
+        if (!audioRecorder.isRecording()) {
+            if (!audioReactive || audioReplayActive) {
+                ImGui::TextDisabled("⏺ Grabar (requiere audio en vivo)");
+            } else if (spectrum.empty()) {
+                ImGui::TextDisabled("⏺ Grabar (esperando al audio)");
+            } else if (ImGui::Button("⏺ Grabar")) {
+                std::time_t t = std::time(nullptr);
+                std::strftime(replayPath, sizeof(replayPath), "audio_%Y%m%d_%H%M%S.vcar", std::localtime(&t));
+                if (audioRecorder.start(replayPath, (int)spectrum.size(), (float)audioSampleRate)) {
+                    recordStartTime = currentTime;
+                }
+            }
+        } else {
+            if (ImGui::Button("⏹ Detener")) {
+                audioRecorder.stop();
+            }
+            ImGui::SameLine();
+            ImGui::Text("%llu frames", (unsigned long long)audioRecorder.frames());
+        }
+        ImGui::InputText("Archivo .vcar", replayPath, sizeof(replayPath));
+        bool replayWanted = audioReplayActive;
+        if (ImGui::Checkbox("▶ Reproducir grabación", &replayWanted)) {
+            if (replayWanted) {
+                audioRecorder.stop();
+                if (audioReplay.open(replayPath)) {
+                    audioReplayActive = true;
+                    audioReactive = true;
+                    replayStartTime = currentTime;
+                    replayFrame = 0;
+                    initAudioSmoothing();
+                }
+            } else {
+                audioReplayActive = false;
+                audioReplay.close();
+            }
+        }
+        ImGui::SameLine();
+        if (ImGui::Checkbox("Lockstep (determinista)", &replayLockstep)) {
+            replayStartTime = currentTime;
+            replayFrame = 0;
+        }
+        if (audioReplayActive) {
+            ImGui::Text("Frames: %zu | Duración: %.1f s", audioReplay.frames(), audioReplay.duration());
+        }
+        
+        // Pista pre-analizada: análisis completo del WAV en todos los núcleos
+        ImGui::Separator();
+        ImGui::Text("🎼 Pista Pre-analizada:");
+        ImGui::InputText("Archivo WAV", offlineTrackPath, sizeof(offlineTrackPath));
+        bool analyzing = offlineJob.valid();
+        if (analyzing && offlineJob.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            try {
+                if (offlineJob.get()) {
+                    offlineTrack = std::move(offlineJobResult);
+                    offlineTrackSynced = false;
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Error analyzing track: " << e.what() << std::endl;
+            }
+            analyzing = false;
+        }
+        if (analyzing) {
+            ImGui::Text("⏳ Analizando...");
+        } else if (ImGui::Button("Analizar")) {
+            std::string path = offlineTrackPath;
+            offlineJob = std::async(std::launch::async, [path]() {
+                return loadOrAnalyzeAudioFile(path, offlineJobResult);
+            });
+        }
+        if (!offlineTrack.empty()) {
+            ImGui::SameLine();
+            if (ImGui::Button(offlineTrackSynced ? "⏹ Detener pista" : "Sincronizar inicio")) {
+                // Pulsar cuando la pista empieza a sonar
+                offlineTrackSynced = !offlineTrackSynced;
+                offlineTrackStart = currentTime;
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Usar BPM detectado")) {
+                bpm = offlineTrack.bpm;
+            }
+            double trackTime = offlineTrackSynced ? currentTime - offlineTrackStart : 0.0;
+            ImGui::Text("BPM: %.1f | Beats: %zu | Secciones: %zu | Duración: %.1f s",
+                       offlineTrack.bpm, offlineTrack.beats.size(), offlineTrack.sections.size(), offlineTrack.duration());
+            if (offlineTrackSynced) {
+                ImGui::Text("Tiempo: %.1f s | Compás: %.2f | Sección: %d",
+                           trackTime, offlineTrack.barPhaseAt(trackTime), offlineTrack.sectionAt(trackTime) + 1);
+            }
+        }
+        
         ImGui::Separator();
         
         // Audio Presets
@@ -2062,13 +2486,13 @@ int main() {
         ImGui::SameLine();
         if (ImGui::Button("Aplicar a Todos")) {
             for (int g = 0; g < 3; ++g) {
-                applyAudioPreset(audioGroups[g], audioPresets[0]); // Default to first preset
+                applyAudioPreset(g, audioPresets[0]); // Default to first preset
             }
         }
         ImGui::SameLine();
         if (ImGui::Button("Wide Full Range")) {
             for (int g = 0; g < 3; ++g) {
-                applyAudioPreset(audioGroups[g], audioPresets[7]); // Wide Full Range preset
+                applyAudioPreset(g, audioPresets[7]); // Wide Full Range preset
             }
         }
         
@@ -2077,7 +2501,7 @@ int main() {
             if (i > 0 && i % 3 != 0) ImGui::SameLine();
             if (ImGui::Button(audioPresets[i].name.c_str())) {
                 for (int g = 0; g < 3; ++g) {
-                    applyAudioPreset(audioGroups[g], audioPresets[i]);
+                    applyAudioPreset(g, audioPresets[i]);
                 }
             }
         }
@@ -2089,135 +2513,65 @@ int main() {
         for (int g = 0; g < 3; ++g) {
             if (ImGui::CollapsingHeader(groupNames[g])) {
                 AudioReactiveGroup& group = audioGroups[g];
+                ImGui::PushID(g);
                 
-                // Frequency range controls
-                ImGui::Text("🎵 Rangos de Frecuencia:");
-                ImGui::Checkbox("Bass (20-150Hz)", &group.bass.enabled);
-                ImGui::SameLine();
-                ImGui::SliderFloat("Sens Bass", &group.bass.sensitivity, 0.1f, 5.0f, "%.1f");
-                
-                ImGui::Checkbox("Low Mid (150-400Hz)", &group.lowMid.enabled);
-                ImGui::SameLine();
-                ImGui::SliderFloat("Sens LM", &group.lowMid.sensitivity, 0.1f, 5.0f, "%.1f");
-                
-                ImGui::Checkbox("Mid (400-2kHz)", &group.mid.enabled);
-                ImGui::SameLine();
-                ImGui::SliderFloat("Sens Mid", &group.mid.sensitivity, 0.1f, 5.0f, "%.1f");
-                
-                ImGui::Checkbox("High Mid (2-6kHz)", &group.highMid.enabled);
-                ImGui::SameLine();
-                ImGui::SliderFloat("Sens HM", &group.highMid.sensitivity, 0.1f, 5.0f, "%.1f");
-                
-                ImGui::Checkbox("Treble (6-20kHz)", &group.treble.enabled);
-                ImGui::SameLine();
-                ImGui::SliderFloat("Sens Treb", &group.treble.sensitivity, 0.1f, 5.0f, "%.1f");
-                
-                ImGui::Separator();
-                
-                // Parameter controls
-                ImGui::Text("🎛️ Parámetros Controlados:");
-                
-                // Row 1
-                ImGui::Checkbox("Tamaño", &group.size.enabled);
-                ImGui::SameLine();
-                ImGui::SliderFloat("Min Size", &group.size.minValue, 0.1f, 2.0f, "%.2f");
-                ImGui::SameLine();
-                ImGui::SliderFloat("Max Size", &group.size.maxValue, 0.1f, 5.0f, "%.2f");
-                ImGui::SameLine();
-                ImGui::SliderFloat("Sens Size", &group.size.sensitivity, 0.1f, 5.0f, "%.1f");
-                
-                // Row 2
-                ImGui::Checkbox("Rotación", &group.rotation.enabled);
-                ImGui::SameLine();
-                ImGui::SliderFloat("Min Rot", &group.rotation.minValue, 0.0f, 360.0f, "%.0f");
-                ImGui::SameLine();
-                ImGui::SliderFloat("Max Rot", &group.rotation.maxValue, 0.0f, 1000.0f, "%.0f");
-                ImGui::SameLine();
-                ImGui::SliderFloat("Sens Rot", &group.rotation.sensitivity, 0.1f, 5.0f, "%.1f");
-                
-                // Row 3
-                ImGui::Checkbox("Ángulo", &group.angle.enabled);
-                ImGui::SameLine();
-                ImGui::SliderFloat("Min Ang", &group.angle.minValue, 0.0f, 360.0f, "%.0f");
-                ImGui::SameLine();
-                ImGui::SliderFloat("Max Ang", &group.angle.maxValue, 0.0f, 360.0f, "%.0f");
-                ImGui::SameLine();
-                ImGui::SliderFloat("Sens Ang", &group.angle.sensitivity, 0.1f, 5.0f, "%.1f");
-                
-                // Row 4
-                ImGui::Checkbox("Mover X", &group.translateX.enabled);
-                ImGui::SameLine();
-                ImGui::SliderFloat("Min TX", &group.translateX.minValue, -2.0f, 2.0f, "%.2f");
-                ImGui::SameLine();
-                ImGui::SliderFloat("Max TX", &group.translateX.maxValue, -2.0f, 2.0f, "%.2f");
-                ImGui::SameLine();
-                ImGui::SliderFloat("Sens TX", &group.translateX.sensitivity, 0.1f, 5.0f, "%.1f");
-                
-                // Row 5
-                ImGui::Checkbox("Mover Y", &group.translateY.enabled);
-                ImGui::SameLine();
-                ImGui::SliderFloat("Min TY", &group.translateY.minValue, -2.0f, 2.0f, "%.2f");
-                ImGui::SameLine();
-                ImGui::SliderFloat("Max TY", &group.translateY.maxValue, -2.0f, 2.0f, "%.2f");
-                ImGui::SameLine();
-                ImGui::SliderFloat("Sens TY", &group.translateY.sensitivity, 0.1f, 5.0f, "%.1f");
-                
-                // Row 6
-                ImGui::Checkbox("Escala X", &group.scaleX.enabled);
-                ImGui::SameLine();
-                ImGui::SliderFloat("Min SX", &group.scaleX.minValue, 0.1f, 2.0f, "%.2f");
-                ImGui::SameLine();
-                ImGui::SliderFloat("Max SX", &group.scaleX.maxValue, 0.1f, 5.0f, "%.2f");
-                ImGui::SameLine();
-                ImGui::SliderFloat("Sens SX", &group.scaleX.sensitivity, 0.1f, 5.0f, "%.1f");
-                
-                // Row 7
-                ImGui::Checkbox("Escala Y", &group.scaleY.enabled);
-                ImGui::SameLine();
-                ImGui::SliderFloat("Min SY", &group.scaleY.minValue, 0.1f, 2.0f, "%.2f");
-                ImGui::SameLine();
-                ImGui::SliderFloat("Max SY", &group.scaleY.maxValue, 0.1f, 5.0f, "%.2f");
-                ImGui::SameLine();
-                ImGui::SliderFloat("Sens SY", &group.scaleY.sensitivity, 0.1f, 5.0f, "%.1f");
-                
-                // Row 8
-                ImGui::Checkbox("Intensidad Color", &group.colorIntensity.enabled);
-                ImGui::SameLine();
-                ImGui::SliderFloat("Min Col", &group.colorIntensity.minValue, 0.0f, 1.0f, "%.2f");
-                ImGui::SameLine();
-                ImGui::SliderFloat("Max Col", &group.colorIntensity.maxValue, 0.0f, 2.0f, "%.2f");
-                ImGui::SameLine();
-                ImGui::SliderFloat("Sens Col", &group.colorIntensity.sensitivity, 0.1f, 5.0f, "%.1f");
-                
-                // Row 9
-                ImGui::Checkbox("Ángulo Grupo", &group.groupAngle.enabled);
-                ImGui::SameLine();
-                ImGui::SliderFloat("Min GA", &group.groupAngle.minValue, 0.0f, 360.0f, "%.0f");
-                ImGui::SameLine();
-                ImGui::SliderFloat("Max GA", &group.groupAngle.maxValue, 0.0f, 360.0f, "%.0f");
-                ImGui::SameLine();
-                ImGui::SliderFloat("Sens GA", &group.groupAngle.sensitivity, 0.1f, 5.0f, "%.1f");
-                
-                // Row 10
-                ImGui::Checkbox("Cantidad Objetos", &group.numObjects.enabled);
-                ImGui::SameLine();
-                ImGui::SliderFloat("Min Obj", &group.numObjects.minValue, 0.0f, 50.0f, "%.0f");
-                ImGui::SameLine();
-                ImGui::SliderFloat("Max Obj", &group.numObjects.maxValue, 0.0f, 100.0f, "%.0f");
-                ImGui::SameLine();
-                ImGui::SliderFloat("Sens Obj", &group.numObjects.sensitivity, 0.1f, 5.0f, "%.1f");
+                // Routing table of this group: fuente -> destino con curva y rango
+                ImGui::Text("🎛️ Matriz de Modulación:");
+                int removeRoute = -1;
+                for (int r = 0; r < modMatrix.size(); ++r) {
+                    if (modMatrix.group[r] != g) continue;
+                    ImGui::PushID(r);
+                    
+                    bool on = modMatrix.enabled[r] != 0;
+                    if (ImGui::Checkbox("##on", &on)) modMatrix.enabled[r] = on ? 1 : 0;
+                    ImGui::SameLine();
+                    int src = modMatrix.source[r];
+                    ImGui::SetNextItemWidth(90.0f);
+                    if (ImGui::Combo("##src", &src, modSourceNames, MOD_SRC_COUNT)) modMatrix.source[r] = (uint8_t)src;
+                    ImGui::SameLine();
+                    int dst = modMatrix.dest[r];
+                    ImGui::SetNextItemWidth(130.0f);
+                    if (ImGui::Combo("##dst", &dst, modDestNames, MOD_DST_COUNT) && dst != modMatrix.dest[r]) {
+                        modMatrix.dest[r] = (uint8_t)dst;
+                        modMatrix.minValue[r] = modDestInfo(dst).defaultMin;
+                        modMatrix.maxValue[r] = modDestInfo(dst).defaultMax;
+                    }
+                    ImGui::SameLine();
+                    int curve = modMatrix.curve[r];
+                    ImGui::SetNextItemWidth(100.0f);
+                    if (ImGui::Combo("##curve", &curve, modCurveNames, MOD_CURVE_COUNT)) modMatrix.curve[r] = (uint8_t)curve;
+                    
+                    const ModDestInfo& info = modDestInfo(modMatrix.dest[r]);
+                    ImGui::SameLine();
+                    ImGui::SetNextItemWidth(80.0f);
+                    ImGui::SliderFloat("Min", &modMatrix.minValue[r], info.clampMin, info.clampMax, "%.2f");
+                    ImGui::SameLine();
+                    ImGui::SetNextItemWidth(80.0f);
+                    ImGui::SliderFloat("Max", &modMatrix.maxValue[r], info.clampMin, info.clampMax, "%.2f");
+                    ImGui::SameLine();
+                    ImGui::SetNextItemWidth(70.0f);
+                    ImGui::SliderFloat("Sens", &modMatrix.sensitivity[r], 0.1f, 5.0f, "%.1f");
+                    ImGui::SameLine();
+                    if (ImGui::SmallButton("X")) removeRoute = r;
+                    
+                    ImGui::PopID();
+                }
+                if (removeRoute >= 0) modMatrix.removeRoute(removeRoute);
+                if (ImGui::Button("➕ Añadir ruta")) {
+                    modMatrix.addRoute(g, MOD_SRC_BASS, MOD_DST_SIZE, 1.0f,
+                                       modDestInfo(MOD_DST_SIZE).defaultMin, modDestInfo(MOD_DST_SIZE).defaultMax);
+                }
                 
                 ImGui::Separator();
                 
-                // Mix presets for this group
-                ImGui::Text("🎚️ Mix de Frecuencias:");
-                ImGui::Checkbox("Mix Bass", &group.useBassMix);
-                ImGui::SameLine();
-                ImGui::Checkbox("Mix Mid", &group.useMidMix);
+                // Suavizado por grupo (en segundos, independiente del FPS)
+                ImGui::Text("〰️ Suavizado:");
+                ImGui::SliderFloat("Ataque (s)", &group.attackTime, 0.0f, 1.0f, "%.3f");
                 ImGui::SameLine();
-                ImGui::Checkbox("Mix Treble", &group.useTrebleMix);
+                ImGui::SliderFloat("Release (s)", &group.releaseTime, 0.0f, 2.0f, "%.3f");
                 ImGui::SameLine();
-                ImGui::Checkbox("Mix Completo", &group.useFullSpectrumMix);
+                ImGui::Checkbox("Resorte crítico", &group.springSmoothing);
+                ImGui::PopID();
             }
         }
         
@@ -2406,6 +2760,29 @@ int main() {
             
             ImGui::Separator();
             
+            // Latencia sonido -> fotones por etapa; cada etapa admite un valor manual
+            ImGui::Text("⏱️ Compensación de Latencia:");
+            for (int st = 0; st < LATENCY_STAGE_COUNT; ++st) {
+                LatencyStage stage = (LatencyStage)st;
+                bool manualStage = latencyModel.isManual(stage);
+                float manualMs = latencyModel.manualValue(stage) * 1000.0f;
+                ImGui::PushID(st);
+                bool changed = ImGui::Checkbox("##manual", &manualStage);
+                ImGui::SameLine();
+                if (manualStage) {
+                    changed |= ImGui::SliderFloat(latencyStageNames[st], &manualMs, 0.0f, 100.0f, "%.1f ms");
+                } else {
+                    ImGui::Text("%s: %.1f ms (medido)", latencyStageNames[st], latencyModel.stage(stage) * 1000.0f);
+                }
+                if (changed) latencyModel.setManual(stage, manualStage, manualMs / 1000.0f);
+                ImGui::PopID();
+            }
+            ImGui::Text("Entrada: %.1f ms | Adelanto visual: %.1f ms | Total: %.1f ms",
+                       latencyModel.inputDelay() * 1000.0f, latencyModel.visualLead() * 1000.0f,
+                       latencyModel.total() * 1000.0f);
+            
+            ImGui::Separator();
+            
             // Controles de FFT para optimización
             ImGui::Text("🎛️ Ajustes de FFT:");
             // Ajuste duplicado eliminado para evitar variables sin uso; ver lógica más abajo
@@ -2429,8 +2806,9 @@ int main() {
             ImGui::End();
         }
 
+        framePhases.next("Audio");
         // --- Inicialización de audio y FFT si es necesario ---
-        if (audioReactive && !audioInit) {
+        if (audioReactive && !audioInit && !audioReplayActive) {
             try {
                 // Usar el monitor seleccionado
                 const char* audioDevice = audioMonitors.empty() ? "default" : audioMonitors[selectedMonitor].first.c_str();
@@ -2443,36 +2821,14 @@ int main() {
                 audio->start();
                 audioInit = true;
                 
-                // Initialize audio groups with default values
-                for (int g = 0; g < 3; ++g) {
-                    audioGroups[g].size.minValue = 0.1f;
-                    audioGroups[g].size.maxValue = 2.0f;
-                    audioGroups[g].rotation.minValue = 0.0f;
-                    audioGroups[g].rotation.maxValue = 500.0f;
-                    audioGroups[g].angle.minValue = 0.0f;
-                    audioGroups[g].angle.maxValue = 360.0f;
-                    audioGroups[g].translateX.minValue = -1.0f;
-                    audioGroups[g].translateX.maxValue = 1.0f;
-                    audioGroups[g].translateY.minValue = -1.0f;
-                    audioGroups[g].translateY.maxValue = 1.0f;
-                    audioGroups[g].scaleX.minValue = 0.1f;
-                    audioGroups[g].scaleX.maxValue = 3.0f;
-                    audioGroups[g].scaleY.minValue = 0.1f;
-                    audioGroups[g].scaleY.maxValue = 3.0f;
-                    audioGroups[g].colorIntensity.minValue = 0.0f;
-                    audioGroups[g].colorIntensity.maxValue = 2.0f;
-                    audioGroups[g].groupAngle.minValue = 0.0f;
-                    audioGroups[g].groupAngle.maxValue = 360.0f;
-                    audioGroups[g].numObjects.minValue = 0.0f;
-                    audioGroups[g].numObjects.maxValue = 50.0f;
-                }
+                initAudioSmoothing();
             } catch (const std::exception& e) {
                 std::cerr << "Error initializing audio: " << e.what() << std::endl;
                 audioReactive = false;
                 audioInit = false;
             }
         }
-        if (!audioReactive && audioInit) {
+        if ((!audioReactive || audioReplayActive) && audioInit) {
             if (audio) audio->stop();
             delete audio;
             delete fft;
@@ -2491,7 +2847,12 @@ int main() {
         else if (fftSizeIndex == 2) currentFftSize = 1024;
         else if (fftSizeIndex == 3) currentFftSize = 2048;
         else if (fftSizeIndex == 4) currentFftSize = 4096;
-        if (currentFftSize != prevFftSize && audioReactive) {
+        if (currentFftSize != prevFftSize && audioReactive && !audioReplayActive) {
+            // A recording has a fixed number of bins: close it before the spectrum resizes
+            if (audioRecorder.isRecording()) {
+                audioRecorder.stop();
+                std::cerr << "Grabación detenida: cambió el tamaño de FFT" << std::endl;
+            }
             // Stop and delete old audio/FFT
             if (audioInit) {
                 if (audio) audio->stop();
@@ -2513,7 +2874,42 @@ int main() {
             audioInit = true;
             prevFftSize = currentFftSize;
         }
-        if (audioReactive && audio && fft) {
+        bool audioFrameReady = false;
+        if (audioReactive && audioReplayActive && audioReplay.isOpen() && audioReplay.frames() > 0) {
+            // Recorded frames replace live capture: no FFT or analysis runs at all
+            size_t frameCount = audioReplay.frames();
+            size_t index;
+            if (replayLockstep) {
+                // The clock and seed are set at the top of the frame; a replay
+                // started mid-frame begins on the next one
+                index = lockstepReplay ? replayFrame++ % frameCount : 0;
+            } else {
+                double duration = audioReplay.duration();
+                double t = currentTime - replayStartTime;
+                if (duration > 0.0) t = std::fmod(t, duration);
+                index = audioReplay.frameAt(t);
+            }
+            audioReplay.read(index, currentAudio, spectrum);
+            audioGraph.addSample(currentAudio.overall, currentTime, 0.0f);
+            audioGraph.updateFPS(currentTime);
+            audioFrameReady = true;
+        } else if (audioReactive && audio && performanceMode) {
+            // OPTIMIZATION: Five Goertzel bands from the capture thread, no FFT or feature pass
+            audio->setLightweight(true);
+            latencyModel.measure(LATENCY_CAPTURE, audio->getBufferLatency());
+            latencyModel.measure(LATENCY_ANALYSIS, 0.0f);
+            float bands[GOERTZEL_BANDS];
+            currentAudio = AudioAnalysis();
+            audio->readGoertzelBands(bands, currentAudio.overall, currentAudio.peak);
+            currentAudio.bass = bands[0];
+            currentAudio.lowMid = bands[1];
+            currentAudio.mid = bands[2];
+            currentAudio.highMid = bands[3];
+            currentAudio.treble = bands[4];
+            currentAudio.rms = std::sqrt(currentAudio.overall);
+            audioFrameReady = true;
+        } else if (audioReactive && audio && fft) {
+            audio->setLightweight(false);
             try {
                 float audioStartTime = glfwGetTime(); // Medir tiempo de inicio
                 if (audio->getLatestBlock(audioBuffer)) {
@@ -2522,149 +2918,111 @@ int main() {
                         int32_t right = audioBuffer[i * 2 + 1];
                         monoBuffer[i] = (left + right) / 2.0f / 2147483648.0f;
                     }
-                    spectrum = fft->compute(monoBuffer);
+                    {
+                        PROFILE_ZONE("FFT");
+                        spectrum = fft->compute(monoBuffer);
+                    }
                     
                     // AUDIO REACTIVE SYSTEM: Advanced analysis
-                    analyzeAudioSpectrum(spectrum, currentAudio);
+                    audioFeatures.setSampleRate((float)audioSampleRate);
+                    audioFeatures.analyze(spectrum, monoBuffer, currentAudio);
                     
                     // Medir latencia de procesamiento
                     float audioEndTime = glfwGetTime();
                     float processingLatency = audioEndTime - audioStartTime;
+                    latencyModel.measure(LATENCY_CAPTURE, audio->getBufferLatency());
+                    latencyModel.measure(LATENCY_ANALYSIS, processingLatency);
                     
                     // Actualizar gráfico de audio
                     audioGraph.addSample(currentAudio.overall, currentTime, processingLatency);
                     audioGraph.updateFPS(currentTime);
-                    
-                    // Apply audio controls to each group
-                    for (int g = 0; g < 3; ++g) {
-                        AudioReactiveGroup& audioGroup = audioGroups[g];
-                        
-                        // Determine which frequency to use based on mix settings
-                        float bassValue = currentAudio.bass;
-                        float midValue = currentAudio.mid;
-                        float trebleValue = currentAudio.treble;
-                        float overallValue = currentAudio.overall;
-                        
-                        // Apply frequency mix
-                        if (audioGroup.useBassMix) {
-                            bassValue *= 2.0f; // Boost bass
-                        }
-                        if (audioGroup.useMidMix) {
-                            midValue *= 2.0f; // Boost mid
-                        }
-                        if (audioGroup.useTrebleMix) {
-                            trebleValue *= 2.0f; // Boost treble
-                        }
-                        if (audioGroup.useFullSpectrumMix) {
-                            overallValue *= 1.5f; // Boost overall
-                        }
-                        
-                        // Apply controls with delta time for smooth transitions
-                        applyAudioControl(audioGroup.size, overallValue, deltaTime);
-                        applyAudioControl(audioGroup.rotation, midValue, deltaTime);
-                        applyAudioControl(audioGroup.angle, trebleValue, deltaTime);
-                        applyAudioControl(audioGroup.translateX, bassValue, deltaTime);
-                        applyAudioControl(audioGroup.translateY, midValue, deltaTime);
-                        applyAudioControl(audioGroup.scaleX, trebleValue, deltaTime);
-                        applyAudioControl(audioGroup.scaleY, bassValue, deltaTime);
-                        applyAudioControl(audioGroup.colorIntensity, overallValue, deltaTime);
-                        applyAudioControl(audioGroup.groupAngle, midValue, deltaTime);
-                        applyAudioControl(audioGroup.numObjects, bassValue, deltaTime);
-                        
-                        // Apply the audio-controlled values to visual objects
-                        if (groups[g].objects.size() < static_cast<size_t>(groups[g].numObjects)) {
-                            groups[g].objects.resize(groups[g].numObjects);
-                            groups[g].targets.resize(groups[g].numObjects);
-                        }
-                        
-                        for (int i = 0; i < groups[g].numObjects; ++i) {
-                            VisualObjectParams& obj = groups[g].objects[i];
-                            
-                            // Apply audio-controlled parameters with safety checks
-                            if (audioGroup.size.enabled) {
-                                float sizeValue = audioGroup.size.currentValue;
-                                if (!std::isnan(sizeValue) && !std::isinf(sizeValue)) {
-                                    obj.triSize = std::max(0.01f, std::min(10.0f, sizeValue));
-                                }
-                            }
-                            if (audioGroup.rotation.enabled) {
-                                float rotValue = audioGroup.rotation.currentValue;
-                                if (!std::isnan(rotValue) && !std::isinf(rotValue)) {
-                                    obj.rotationSpeed = std::max(0.0f, std::min(2000.0f, rotValue));
-                                }
-                            }
-                            if (audioGroup.angle.enabled) {
-                                float angleValue = audioGroup.angle.currentValue;
-                                if (!std::isnan(angleValue) && !std::isinf(angleValue)) {
-                                    obj.angle = angleValue * (3.14159265f / 180.0f);
-                                }
-                            }
-                            if (audioGroup.translateX.enabled) {
-                                float txValue = audioGroup.translateX.currentValue;
-                                if (!std::isnan(txValue) && !std::isinf(txValue)) {
-                                    obj.translateX = std::max(-5.0f, std::min(5.0f, txValue));
-                                }
-                            }
-                            if (audioGroup.translateY.enabled) {
-                                float tyValue = audioGroup.translateY.currentValue;
-                                if (!std::isnan(tyValue) && !std::isinf(tyValue)) {
-                                    obj.translateY = std::max(-5.0f, std::min(5.0f, tyValue));
-                                }
-                            }
-                            if (audioGroup.scaleX.enabled) {
-                                float sxValue = audioGroup.scaleX.currentValue;
-                                if (!std::isnan(sxValue) && !std::isinf(sxValue)) {
-                                    obj.scaleX = std::max(0.01f, std::min(10.0f, sxValue));
-                                }
-                            }
-                            if (audioGroup.scaleY.enabled) {
-                                float syValue = audioGroup.scaleY.currentValue;
-                                if (!std::isnan(syValue) && !std::isinf(syValue)) {
-                                    obj.scaleY = std::max(0.01f, std::min(10.0f, syValue));
-                                }
-                            }
-                            if (audioGroup.colorIntensity.enabled) {
-                                float intensity = audioGroup.colorIntensity.currentValue;
-                                if (!std::isnan(intensity) && !std::isinf(intensity)) {
-                                    intensity = std::max(0.0f, std::min(5.0f, intensity));
-                                    obj.colorTop.x = std::min(1.0f, obj.colorTop.x * intensity);
-                                    obj.colorTop.y = std::min(1.0f, obj.colorTop.y * intensity);
-                                    obj.colorTop.z = std::min(1.0f, obj.colorTop.z * intensity);
-                                }
-                            }
-                        }
-                        
-                        // Apply group-level controls with safety checks
-                        if (audioGroup.groupAngle.enabled) {
-                            float gaValue = audioGroup.groupAngle.currentValue;
-                            if (!std::isnan(gaValue) && !std::isinf(gaValue)) {
-                                groups[g].groupAngle = gaValue * (3.14159265f / 180.0f);
-                            }
-                        }
-                        if (audioGroup.numObjects.enabled) {
-                            float numValue = audioGroup.numObjects.currentValue;
-                            if (!std::isnan(numValue) && !std::isinf(numValue)) {
-                                groups[g].numObjects = (int)std::max(0.0f, std::min(100.0f, numValue));
-                            }
-                        }
+                }
+                
+                // Band envelopes are published continuously by the capture thread, so they
+                // are sampled every frame instead of waiting for the next FFT block
+                audio->readBandEnvelopes(currentAudio.envelope, currentAudio.envelopePeak);
+                
+                // Pitch tracked on the capture thread
+                audio->setPitchHop(pitchHop);
+                audio->readPitch(currentAudio.pitchHz, currentAudio.pitchConfidence, currentAudio.pitchMidi);
+                
+                // Drum events since the last frame; drum[] decays between hits
+                audio->setDrumSensitivity(drumSensitivity);
+                float drumDecay = 1.0f - smoothing::expAlpha(0.15f, deltaTime);
+                for (int p = 0; p < DRUM_PART_COUNT; ++p) {
+                    currentAudio.drumHit[p] = false;
+                    currentAudio.drumVelocity[p] = 0.0f;
+                    currentAudio.drum[p] *= drumDecay;
+                }
+                DrumEvent drumEvent;
+                while (audio->popDrumEvent(drumEvent)) {
+                    int p = drumEvent.part;
+                    currentAudio.drumHit[p] = true;
+                    currentAudio.drumVelocity[p] = std::max(currentAudio.drumVelocity[p], drumEvent.velocity);
+                    currentAudio.drum[p] = std::max(currentAudio.drum[p], drumEvent.velocity);
+                    if (beatPhaseLock && p == DRUM_KICK) {
+                        // The kick sounded inputDelay ago; nudge the beat clock toward it
+                        beatClock.observeBeat(currentTime - latencyModel.inputDelay());
                     }
                 }
+                audioFrameReady = true;
             } catch (const std::exception& e) {
                 std::cerr << "Error processing audio: " << e.what() << std::endl;
                 // Reset audio analysis to safe values
-                currentAudio.bass = 0.0f;
-                currentAudio.lowMid = 0.0f;
-                currentAudio.mid = 0.0f;
-                currentAudio.highMid = 0.0f;
-                currentAudio.treble = 0.0f;
-                currentAudio.overall = 0.0f;
-                currentAudio.peak = 0.0f;
-                currentAudio.rms = 0.0f;
+                currentAudio = AudioAnalysis();
+            }
+        }
+        if (audioReactive && !audioReplayActive && offlineTrackSynced && !offlineTrack.empty()) {
+            // Frames centrados de la pista pre-analizada: sin latencia de lookahead.
+            // Pitch y batería siguen viniendo de la captura en vivo.
+            double trackTime = currentTime - offlineTrackStart;
+            if (trackTime > offlineTrack.duration()) {
+                offlineTrackSynced = false;
+            } else {
+                AudioAnalysis live = currentAudio;
+                // Frames futuros conocidos: se lee el que sonará cuando este frame se vea
+                currentAudio = offlineTrack.frameAt(trackTime + latencyModel.visualLead());
+                currentAudio.pitchHz = live.pitchHz;
+                currentAudio.pitchConfidence = live.pitchConfidence;
+                currentAudio.pitchMidi = live.pitchMidi;
+                for (int p = 0; p < DRUM_PART_COUNT; ++p) {
+                    currentAudio.drumHit[p] = live.drumHit[p];
+                    currentAudio.drumVelocity[p] = live.drumVelocity[p];
+                    currentAudio.drum[p] = live.drum[p];
+                }
+                audioFrameReady = true;
+            }
+        }
+        if (audioFrameReady) {
+            if (audioRecorder.isRecording()) {
+                audioRecorder.write(currentTime - recordStartTime, currentAudio, spectrum);
+            }
+
+            // AUDIO REACTIVE SYSTEM: Evaluate every route of every group in one pass
+            fillModSources(currentAudio, modSources);
+            modSources[MOD_SRC_BEAT] = beatPulse;
+            modSources[MOD_SRC_BEAT_PHASE] = beatPhase;
+            modMatrix.evaluate(modSources, 3, modTargets, modActive);
+            for (int slot = 0; slot < AUDIO_MOD_SLOTS; ++slot) {
+                if (!modActive[slot]) continue;
+                const AudioReactiveGroup& audioGroup = audioGroups[slot / MOD_DST_COUNT];
+                audioSmoothing.setTarget(slot, modTargets[slot]);
+                audioSmoothing.setTimes(slot, audioGroup.attackTime, audioGroup.releaseTime);
+                audioSmoothing.setMode(slot, audioGroup.springSmoothing ? SMOOTH_SPRING : SMOOTH_EXPONENTIAL);
+            }
+            
+            // AUDIO REACTIVE SYSTEM: Time-constant smoothing of all destinations in one pass
+            audioSmoothing.update(deltaTime);
+            
+            // Apply the audio-controlled values to visual objects
+            for (int g = 0; g < 3; ++g) {
+                applyAudioModulation(groups[g], g);
             }
         }
 
         
         
+        framePhases.next("Animación y randomización");
         // --- Actualización de objetos: rotación automática y animación de color ---
         for (int g = 0; g < 3; ++g) {
             // Asegurar que el vector tenga el tamaño correcto
@@ -2711,6 +3069,16 @@ int main() {
             }
         }
         // 3. Randomización y recreación de shapes por grupo (MEJORADA)
+        if (randomSmoothing.size() == 0) {
+            for (int g = 0; g < 3; ++g) randomSmoothing.add((float)groups[g].numObjects, 0.0f, 0.0f);
+            randomSmoothing.add(groupSeparation, 0.0f, 0.0f);
+            for (int g = 0; g < 3; ++g) randomSmoothing.add((float)groups[g].objects[0].shapeType, 0.0f, 0.0f);
+            for (int g = 0; g < 3; ++g) randomSmoothing.add((float)groups[g].objects[0].nSegments, 0.0f, 0.0f);
+        }
+        // Objetivo de cantidad por grupo, compartido con la randomización por eventos
+        static int tgtNum[3] = {groups[0].numObjects, groups[1].numObjects, groups[2].numObjects};
+        bool shapeAffected[3] = {false, false, false};
+        bool segmentsAffected[3] = {false, false, false};
         for (int g = 0; g < 3; ++g) {
             VisualObjectParams& obj = groups[g].objects[0];
             VisualObjectTargets& tgt = groups[g].targets[0];
@@ -2718,14 +3086,8 @@ int main() {
             // AUDIO-DRIVEN RANDOMIZATION: Use audio frequencies to drive randomization
             float audioRandomFactor = 1.0f;
             if (audioReactive && !spectrum.empty()) {
-                // Use different frequency bands for different groups
-                if (g == 0) { // Center - Bass driven
-                    audioRandomFactor = currentAudio.bass * 2.0f;
-                } else if (g == 1) { // Right - Mid driven
-                    audioRandomFactor = currentAudio.mid * 2.0f;
-                } else { // Left - Treble driven
-                    audioRandomFactor = currentAudio.treble * 2.0f;
-                }
+                // Each group follows one drum part: center kick, right snare, left hi-hat
+                audioRandomFactor = currentAudio.drum[g] * 3.0f;
                 
                 // Clamp audio factor
                 audioRandomFactor = std::max(0.1f, std::min(3.0f, audioRandomFactor));
@@ -2745,7 +3107,8 @@ int main() {
                     currentInterval = std::max(0.1f, currentInterval); // Minimum interval
                 }
                 
-                if (timeSinceLastRandom >= currentInterval) {
+                // Con "en el beat" se espera al siguiente beat en pantalla
+                if (timeSinceLastRandom >= currentInterval && (!randomizeOnBeat || beatTriggered)) {
                     shouldRandomize = true;
                     lastRandomizeTime[g] = currentTime;
                     
@@ -2777,7 +3140,18 @@ int main() {
                     tgtShapeType[g] = (obj.shapeType + 1) % SHAPE_COUNT;
                 }
             }
-            obj.shapeType += (int)((tgtShapeType[g] - obj.shapeType) * randomLerpSpeed * audioRandomFactor + 0.5f);
+            // AUDIO-DRIVEN RANDOMIZATION: Apply audio factor to all random changes (rescaled to deltaTime)
+            float adjustedLerpSpeed = smoothing::perFrameLerpAlpha(randomLerpSpeed * audioRandomFactor, deltaTime);
+            float shapeTau = smoothing::tauFromPerFrameLerp(randomLerpSpeed * audioRandomFactor);
+            shapeAffected[g] = randomize && randomAffect.shapeType;
+            if (shapeAffected[g]) {
+                // Seguir cambios externos (UI, presets) sin transición
+                if ((int)lroundf(randomSmoothing.value(RANDOM_SLOT_SHAPE + g)) != obj.shapeType) {
+                    randomSmoothing.snap(RANDOM_SLOT_SHAPE + g, (float)obj.shapeType);
+                }
+                randomSmoothing.setTarget(RANDOM_SLOT_SHAPE + g, (float)tgtShapeType[g]);
+                randomSmoothing.setTimes(RANDOM_SLOT_SHAPE + g, shapeTau, shapeTau);
+            }
             
             // Randomizar nSegments por grupo
             static int tgtNSegments[3] = {obj.nSegments, obj.nSegments, obj.nSegments};
@@ -2786,15 +3160,19 @@ int main() {
                 int max = randomLimits.segMax;
                 tgtNSegments[g] = min + rand() % (max - min + 1);
             }
-            obj.nSegments += (int)((tgtNSegments[g] - obj.nSegments) * randomLerpSpeed * audioRandomFactor + 0.5f);
+            segmentsAffected[g] = randomize && randomAffect.nSegments;
+            if (segmentsAffected[g]) {
+                if ((int)lroundf(randomSmoothing.value(RANDOM_SLOT_SEGMENTS + g)) != obj.nSegments) {
+                    randomSmoothing.snap(RANDOM_SLOT_SEGMENTS + g, (float)obj.nSegments);
+                }
+                randomSmoothing.setTarget(RANDOM_SLOT_SEGMENTS + g, (float)tgtNSegments[g]);
+                randomSmoothing.setTimes(RANDOM_SLOT_SEGMENTS + g, shapeTau, shapeTau);
+            }
             
             // Inicializar targets si es la primera vez
             if (tgt.target.triSize == 0.0f) tgt.target = obj;
             
             if (randomize) {
-                // AUDIO-DRIVEN RANDOMIZATION: Apply audio factor to all random changes
-                float adjustedLerpSpeed = randomLerpSpeed * audioRandomFactor;
-                
                 // triSize - only if selected
                 if (shouldRandomize && randomAffect.triSize) {
                     tgt.target.triSize = randomLimits.sizeMin + frand() * (randomLimits.sizeMax - randomLimits.sizeMin);
@@ -2874,10 +3252,9 @@ int main() {
                     groups[g].groupAngle += (tgtGroupAngle[g] - groups[g].groupAngle) * adjustedLerpSpeed;
                 }
                 
-                            // Randomizar cantidad de objetos por grupo - only if selected
+            // Randomizar cantidad de objetos por grupo - only if selected.
+            // Solo se elige el objetivo: la transición la hacen los slots 0-2 de randomSmoothing
             if (shouldRandomize) {
-                static int tgtNumObjects[3] = {groups[0].numObjects, groups[1].numObjects, groups[2].numObjects};
-                
                 // Configuración especial para el túnel psicodélico
                 bool isTunnelPreset = false;
                 for (const auto& preset : animationPresets) {
@@ -2892,46 +3269,43 @@ int main() {
                         // Para el túnel, cambios más dramáticos en la cantidad
                         float tunnelChoice = frand();
                         if (tunnelChoice < 0.3f) {
-                            tgtNumObjects[g] = 5 + rand() % 10; // 5-15 objetos
+                            tgtNum[g] = 5 + rand() % 10; // 5-15 objetos
                         } else if (tunnelChoice < 0.7f) {
-                            tgtNumObjects[g] = 20 + rand() % 30; // 20-50 objetos
+                            tgtNum[g] = 20 + rand() % 30; // 20-50 objetos
                         } else {
-                            tgtNumObjects[g] = 50 + rand() % 50; // 50-100 objetos
+                            tgtNum[g] = 50 + rand() % 50; // 50-100 objetos
                         }
                     } else {
-                        tgtNumObjects[g] = randomLimits.numCenterMin + rand() % (randomLimits.numCenterMax - randomLimits.numCenterMin + 1);
+                        tgtNum[g] = randomLimits.numCenterMin + rand() % (randomLimits.numCenterMax - randomLimits.numCenterMin + 1);
                     }
-                    groups[g].numObjects += (int)((tgtNumObjects[g] - groups[g].numObjects) * adjustedLerpSpeed + 0.5f);
                 } else if (randomAffect.numRight && g == 1) {
                     if (isTunnelPreset) {
                         float tunnelChoice = frand();
                         if (tunnelChoice < 0.4f) {
-                            tgtNumObjects[g] = 8 + rand() % 12; // 8-20 objetos
+                            tgtNum[g] = 8 + rand() % 12; // 8-20 objetos
                         } else if (tunnelChoice < 0.8f) {
-                            tgtNumObjects[g] = 25 + rand() % 25; // 25-50 objetos
+                            tgtNum[g] = 25 + rand() % 25; // 25-50 objetos
                         } else {
-                            tgtNumObjects[g] = 60 + rand() % 40; // 60-100 objetos
+                            tgtNum[g] = 60 + rand() % 40; // 60-100 objetos
                         }
                     } else {
-                        tgtNumObjects[g] = randomLimits.numRightMin + rand() % (randomLimits.numRightMax - randomLimits.numRightMin + 1);
+                        tgtNum[g] = randomLimits.numRightMin + rand() % (randomLimits.numRightMax - randomLimits.numRightMin + 1);
                     }
-                    groups[g].numObjects += (int)((tgtNumObjects[g] - groups[g].numObjects) * adjustedLerpSpeed + 0.5f);
                 } else if (randomAffect.numLeft && g == 2) {
                     if (isTunnelPreset) {
                         float tunnelChoice = frand();
                         if (tunnelChoice < 0.4f) {
-                            tgtNumObjects[g] = 8 + rand() % 12; // 8-20 objetos
+                            tgtNum[g] = 8 + rand() % 12; // 8-20 objetos
                         } else if (tunnelChoice < 0.8f) {
-                            tgtNumObjects[g] = 25 + rand() % 25; // 25-50 objetos
+                            tgtNum[g] = 25 + rand() % 25; // 25-50 objetos
                         } else {
-                            tgtNumObjects[g] = 60 + rand() % 40; // 60-100 objetos
+                            tgtNum[g] = 60 + rand() % 40; // 60-100 objetos
                         }
                     } else {
-                        tgtNumObjects[g] = randomLimits.numLeftMin + rand() % (randomLimits.numLeftMax - randomLimits.numLeftMin + 1);
+                        tgtNum[g] = randomLimits.numLeftMin + rand() % (randomLimits.numLeftMax - randomLimits.numLeftMin + 1);
                     }
-                    groups[g].numObjects += (int)((tgtNumObjects[g] - groups[g].numObjects) * adjustedLerpSpeed + 0.5f);
                 }
-                groups[g].numObjects = std::max(0, std::min(100, groups[g].numObjects)); // Limitar a 0-100
+                tgtNum[g] = std::max(0, std::min(100, tgtNum[g])); // Limitar a 0-100
             }
             }
             // Si cambió el tamaño, los colores o la figura, recrear el shape
@@ -2953,10 +3327,13 @@ int main() {
             static bool prevFractalMode = false;
             if (fractalMode != prevFractalMode) fractalChanged = true;
             
-            // Para fractales, regenerar cada frame para la animación
-            bool shouldRegenerate = obj.triSize != prevSize || colorChanged || shapeChanged || fractalChanged;
+            // Solo los fractales tienen geometría propia: las figuras base son mallas unitarias
+            // (tamaño y colores van por instancia). El fractal sigue la figura del grupo
+            // central; regenerarlo para la animación
+            bool fractalSource = fractalMode && fractalKind == 0 && !(fractalOnGpu && gpuFractal.ready()) && g == 0;
+            bool shouldRegenerate = fractalSource && (obj.triSize != prevSize || colorChanged || shapeChanged || fractalChanged);
             // OPTIMIZATION: Reduce fractal regeneration frequency
-            if (fractalMode) {
+            if (fractalSource) {
                 static float lastFractalUpdate = 0.0f;
                 float fractalUpdateInterval = 0.1f; // Update every 100ms instead of every frame
                 shouldRegenerate = shouldRegenerate || (currentTime - lastFractalUpdate > fractalUpdateInterval);
@@ -2964,20 +3341,10 @@ int main() {
             }
             
             if (shouldRegenerate) {
-                // OPTIMIZATION: Only delete and recreate if we have a valid cached VBO
-                if (currentCachedVBO) {
-                    // Find and remove the current VBO from cache
-                    for (auto it = vboCache.begin(); it != vboCache.end(); ++it) {
-                        if (&(*it) == currentCachedVBO) {
-                            if (it->VAO) glDeleteVertexArrays(1, &it->VAO);
-                            if (it->VBO) glDeleteBuffers(1, &it->VBO);
-                            if (it->instanceVBO) glDeleteBuffers(1, &it->instanceVBO);
-                            vboCache.erase(it);
-                            break;
-                        }
-                    }
-                    currentCachedVBO = nullptr;
-                }
+                // OPTIMIZATION: Animated fractals change under the same key, so the
+                // previous entry is dropped instead of piling up in the LRU
+                geometryCache.remove(currentGeometry);
+                currentGeometry = GeometryHandle();
                 
                 // Antes de crear el shape, si onlyRGB está activo, forzar colores a RGB puros
                 if (onlyRGB) {
@@ -2991,8 +3358,8 @@ int main() {
                                     curColorLeft[0], curColorLeft[1], curColorLeft[2],
                                     curColorRight[0], curColorRight[1], curColorRight[2]};
                 
-                currentCachedVBO = findOrCreateCachedVBO(
-                    obj.shapeType, obj.triSize, newColors, actualSegments, fractalMode, fractalDepth
+                currentGeometry = findOrCreateCachedVBO(
+                    obj.shapeType, obj.triSize, newColors, actualSegments, fractalMode, fractalDepth, currentTime
                 );
                 
                 prevSize = obj.triSize;
@@ -3006,21 +3373,50 @@ int main() {
             }
         }
 
-        // Randomización de cantidad de figuras por grupo
-        static int tgtNum[3] = {groups[0].numObjects, groups[1].numObjects, groups[2].numObjects};
+        // Randomización de cantidad de figuras por grupo y de separación de grupos
+        // Las cantidades se suavizan como float con constante de tiempo, igual a cualquier FPS
+        float randomTau = smoothing::tauFromPerFrameLerp(randomLerpSpeed);
+        bool numAffected[3] = {false, false, false};
         for (int g = 0; g < 3; ++g) {
             // Randomizar cantidad de figuras por grupo
             bool affect = (g == 0) ? randomAffect.numCenter : (g == 1) ? randomAffect.numRight : randomAffect.numLeft;
             int min = (g == 0) ? randomLimits.numCenterMin : (g == 1) ? randomLimits.numRightMin : randomLimits.numLeftMin;
             int max = (g == 0) ? randomLimits.numCenterMax : (g == 1) ? randomLimits.numRightMax : randomLimits.numLeftMax;
-            if (randomize && affect) {
+            numAffected[g] = randomize && affect;
+            if (numAffected[g]) {
+                // Seguir cambios externos (UI, audio, presets) sin transición
+                if ((int)lroundf(randomSmoothing.value(g)) != groups[g].numObjects) {
+                    randomSmoothing.snap(g, (float)groups[g].numObjects);
+                }
                 if (groups[g].numObjects == tgtNum[g]) {
                     tgtNum[g] = min + rand() % (max - min + 1);
                 }
-                groups[g].numObjects += (int)((tgtNum[g] - groups[g].numObjects) * randomLerpSpeed + 0.5f);
-                // Asegurar que no sea negativo
-                if (groups[g].numObjects < 0) groups[g].numObjects = 0;
+                randomSmoothing.setTarget(g, (float)tgtNum[g]);
+                randomSmoothing.setTimes(g, randomTau, randomTau);
+            }
+        }
+        bool separationAffected = randomize && randomizeGroupSeparation;
+        if (separationAffected) {
+            if (randomSmoothing.value(RANDOM_SLOT_SEPARATION) != groupSeparation) {
+                randomSmoothing.snap(RANDOM_SLOT_SEPARATION, groupSeparation);
+            }
+            if (fabs(groupSeparation - targetGroupSeparation) < 0.01f) {
+                targetGroupSeparation = frand() * 2.0f; // entre 0 y 2
             }
+            randomSmoothing.setTarget(RANDOM_SLOT_SEPARATION, targetGroupSeparation);
+            randomSmoothing.setTimes(RANDOM_SLOT_SEPARATION, randomTau, randomTau);
+        }
+        randomSmoothing.update(deltaTime);
+        for (int g = 0; g < 3; ++g) {
+            VisualObjectParams& obj = groups[g].objects[0];
+            if (shapeAffected[g]) obj.shapeType = (int)lroundf(randomSmoothing.value(RANDOM_SLOT_SHAPE + g));
+            if (segmentsAffected[g]) obj.nSegments = (int)lroundf(randomSmoothing.value(RANDOM_SLOT_SEGMENTS + g));
+            if (!numAffected[g]) continue;
+            // Asegurar que no sea negativo
+            groups[g].numObjects = std::max(0, (int)lroundf(randomSmoothing.value(g)));
+        }
+        if (separationAffected) {
+            groupSeparation = randomSmoothing.value(RANDOM_SLOT_SEPARATION);
         }
 
         // Cambiar swap interval si cambia el modo
@@ -3035,15 +3431,9 @@ int main() {
             prevFpsMode = fpsMode;
         }
 
-        // 3. Randomización y animación de separación de grupos
-        if (randomize && randomizeGroupSeparation) {
-            if (fabs(groupSeparation - targetGroupSeparation) < 0.01f) {
-                targetGroupSeparation = frand() * 2.0f; // entre 0 y 2
-            }
-            groupSeparation += (targetGroupSeparation - groupSeparation) * randomLerpSpeed;
-        }
-
+        framePhases.next("Instancias y envío GL");
         // OPTIMIZATION: Clear screen once at the beginning
+        gpuTimer.begin("Geometría");
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -3067,38 +3457,83 @@ int main() {
             testInstance.angle = audioTestMode.testRotation * (3.14159265f / 180.0f); // Convert to radians
             testInstance.scaleX = audioTestMode.testSize;
             testInstance.scaleY = audioTestMode.testSize;
+            testInstance.colorTop = testInstance.colorLeft = testInstance.colorRight =
+                packColor(audioTestMode.testColor.x, audioTestMode.testColor.y, audioTestMode.testColor.z);
             allInstances.push_back(testInstance);
             
-            // Use test colors for VBO
-            float testColors[9] = {
-                audioTestMode.testColor.x, audioTestMode.testColor.y, audioTestMode.testColor.z,
-                audioTestMode.testColor.x, audioTestMode.testColor.y, audioTestMode.testColor.z,
-                audioTestMode.testColor.x, audioTestMode.testColor.y, audioTestMode.testColor.z
-            };
-            
-            // Create or update VBO for test triangle
-            CachedVBO* testVBO = findOrCreateCachedVBO(
-                SHAPE_TRIANGLE, // Always triangle for test
-                audioTestMode.testSize,
-                testColors,
-                3, // Triangle has 3 vertices
-                false, // No fractal for test
-                0.0f
-            );
-            
-            // Render test triangle
-            if (testVBO && !allInstances.empty()) {
-                renderBatch(testVBO, allInstances, shaderProgram, (float)width / (float)height);
+            // Render test triangle: unit mesh, the size is the instance scale
+            renderBatch(meshLibrary.vao(), meshLibrary.range(SHAPE_TRIANGLE, 3), allInstances, shaderProgram, (float)width / (float)height);
+        } else if (fractalMode && fractalKind >= 3 && escapePass.ready()) {
+            // Mandelbrot / Julia: one fragment pass over the whole screen, colored with the central group's palette
+            const VisualObjectParams& po = groups[0].objects[0];
+            EscapeTimePass::Params params;
+            params.type = fractalKind == 3 ? EscapeTimePass::MANDELBROT : EscapeTimePass::JULIA;
+            float colors[9] = {po.colorTop.x, po.colorTop.y, po.colorTop.z,
+                               po.colorLeft.x, po.colorLeft.y, po.colorLeft.z,
+                               po.colorRight.x, po.colorRight.y, po.colorRight.z};
+            if (!onlyRGB) memcpy(params.colors, colors, sizeof(colors));
+            params.colorCycle = currentTime * 0.05f;
+            // La profundidad fractal acerca la vista
+            params.zoom = powf(1.6f, fractalDepth - 1.0f);
+            if (params.type == EscapeTimePass::MANDELBROT) {
+                params.centerX = fractalDepth > 1.0f ? -0.743643f : -0.5f;
+                params.centerY = fractalDepth > 1.0f ? 0.131825f : 0.0f;
+                if (audioReactive) params.zoom *= 1.0f + 0.15f * currentAudio.overall;
+            } else {
+                // AUDIO REACTIVE SYSTEM: graves y agudos desplazan la constante de Julia
+                float orbit = currentTime * 0.1f;
+                params.juliaX = 0.7885f * cosf(orbit);
+                params.juliaY = 0.7885f * sinf(orbit);
+                if (audioReactive) {
+                    params.juliaX += (currentAudio.bass - 0.5f) * 0.1f;
+                    params.juliaY += (currentAudio.treble - 0.5f) * 0.1f;
+                    params.colorCycle += currentAudio.mid * 0.2f;
+                }
+                params.centerX = 0.0f;
             }
+            escapePass.render(params, width, height);
         } else {
+            // El fractal en CPU usa la figura del grupo central; en GPU cada grupo la suya
+            const VisualObjectParams& meshObj = groups[0].objects[0];
+            size_t groupInstanceStart[4] = {0, 0, 0, 0};
+            
+            // Sierpinski/Koch: solo se construyen los niveles que falten (p. ej. si el audio sube la profundidad)
+            bool meshFractal = fractalMode && fractalKind != 0;
+            fractalEngine.setEnabled(meshFractal);
+            fractalEngine.setFractalType(fractalKind == 2 ? VisualFractalEngine::FractalType::KOCH_SNOWFLAKE
+                                                          : VisualFractalEngine::FractalType::SIERPINSKI_TRIANGLE);
+            fractalEngine.setDepth(fractalDepth);
+            fractalEngine.setAudioDepthRange(fractalAudioDepth);
+            fractalEngine.setAudioLevel(audioReactive ? currentAudio.overall : 0.0f);
+            fractalEngine.update();
+            // Los fractales IFS llevan tamaño y colores en la geometría
+            bool ifsFractal = fractalMode && !meshFractal;
+            bool useSdf = sdfShapesEnabled && sdfShapes.ready();
+            bool useThickLines = thickLines && lineRenderer.ready();
+            
             // Construir instancias para los 3 grupos con offsets solicitados
             for (int g = 0; g < 3; ++g) {
                 VisualObjectParams& obj = groups[g].objects[0];
+                // Cada grupo con su propia figura. Las mallas base son unitarias: el
+                // tamaño entra en la escala de instancia
+                MeshRange groupMesh = meshLibrary.range(obj.shapeType, obj.nSegments);
+                float meshScale = ifsFractal ? 1.0f : obj.triSize;
+                bool quad = !fractalMode && ((useSdf && SdfShapeRenderer::supports(obj.shapeType)) ||
+                                             (useThickLines && LineRenderer::supports(obj.shapeType)));
+                auto emit = [&](const InstanceData& inst) {
+                    if (fractalMode) allInstances.push_back(inst);
+                    else if (quad) addQuadInstance(obj.shapeType, obj.nSegments, inst);
+                    else addMeshInstance(groupMesh, inst);
+                };
+                // AUDIO REACTIVE SYSTEM: centro con graves, derecha con medios, izquierda con agudos
+                float band = g == 0 ? currentAudio.bass : (g == 1 ? currentAudio.mid : currentAudio.treble);
+                float groupLineWidth = lineWidthPx + (audioReactive ? lineWidthAudio * band : 0.0f);
                 float baseX = 0.0f;
                 if (g == 0) baseX = -1.0f;           // Centro: -1.0 en X
                 else if (g == 1) baseX = groupSeparation; // Derecha: según separación
                 else baseX = -1.5f;                   // Izquierda: -1.5 en X
 
+                groupInstanceStart[g] = allInstances.size();
                 for (int i = 0; i < groups[g].numObjects; ++i) {
                     float theta = (2.0f * 3.14159265f * i) / std::max(1, groups[g].numObjects) + groups[g].groupAngle;
                     float r = 1.0f;
@@ -3109,8 +3544,20 @@ int main() {
                     instance.offsetX = tx;
                     instance.offsetY = ty;
                     instance.angle = obj.angle;
-                    instance.scaleX = obj.scaleX;
-                    instance.scaleY = obj.scaleY;
+                    instance.scaleX = obj.scaleX * meshScale;
+                    instance.scaleY = obj.scaleY * meshScale;
+                    instance.lineWidth = groupLineWidth;
+                    // Colores propios de cada objeto (los fractales IFS ya los traen en la geometría)
+                    const VisualObjectParams& colorObj = groups[g].objects[std::min<size_t>(i, groups[g].objects.size() - 1)];
+                    if (ifsFractal || onlyRGB) {
+                        instance.colorTop = packColor(1.0f, 0.0f, 0.0f);
+                        instance.colorLeft = packColor(0.0f, 1.0f, 0.0f);
+                        instance.colorRight = packColor(0.0f, 0.0f, 1.0f);
+                    } else {
+                        instance.colorTop = packColor(colorObj.colorTop.x, colorObj.colorTop.y, colorObj.colorTop.z);
+                        instance.colorLeft = packColor(colorObj.colorLeft.x, colorObj.colorLeft.y, colorObj.colorLeft.z);
+                        instance.colorRight = packColor(colorObj.colorRight.x, colorObj.colorRight.y, colorObj.colorRight.z);
+                    }
 
                     // Aplicar glitch si corresponde
                     if (glitchEffectEnabled && glitchActive) {
@@ -3120,60 +3567,101 @@ int main() {
                         instance.scaleY *= glitchScaleY;
 
                         if (frand() < glitchSplitRatio) {
-                            allInstances.push_back(instance);
+                            emit(instance);
                             InstanceData splitInstance = instance;
                             splitInstance.offsetX += (frand() - 0.5f) * glitchIntensity * 0.3f;
                             splitInstance.offsetY += (frand() - 0.5f) * glitchIntensity * 0.3f;
                             splitInstance.scaleX *= 0.7f;
                             splitInstance.scaleY *= 0.7f;
-                            allInstances.push_back(splitInstance);
+                            emit(splitInstance);
                         } else {
-                            allInstances.push_back(instance);
+                            emit(instance);
                         }
                     } else {
-                        allInstances.push_back(instance);
+                        emit(instance);
                     }
                 }
             }
 
-            // OPTIMIZATION: Update cached VBO if needed
-            float colors[9] = {colorTopArr[0], colorTopArr[1], colorTopArr[2],
-                              colorLeftArr[0], colorLeftArr[1], colorLeftArr[2],
-                              colorRightArr[0], colorRightArr[1], colorRightArr[2]};
+            groupInstanceStart[3] = allInstances.size();
             
-            bool needNewVBO = false;
-            if (!currentCachedVBO || 
-                currentCachedVBO->shapeType != groups[0].objects[0].shapeType ||
-                currentCachedVBO->size != groups[0].objects[0].triSize ||
-                currentCachedVBO->fractalMode != fractalMode ||
-                currentCachedVBO->fractalDepth != fractalDepth) {
-                needNewVBO = true;
-            }
+            // OPTIMIZATION: Any mix of base shapes in one multi-draw per primitive
+            if (!fractalMode) {
+                renderMeshBuckets(shaderProgram, (float)width / (float)height);
+                renderQuadBuckets(width, height, outlineOnly ? outlineWidth : 0.0f);
+            } else if (meshFractal) {
+                // Unit mesh from the shared level buffer, with per-instance size and colors
+                renderBatch(fractalEngine.vao(), fractalEngine.currentRange(), allInstances, shaderProgram, (float)width / (float)height);
+            } else if (fractalOnGpu && gpuFractal.ready()) {
+                // OPTIMIZATION: One draw per group; the tree is expanded in the vertex shader
+                int levels = std::max(1, std::min((int)GpuFractal::MAX_LEVELS, (int)fractalDepth));
+                for (int g = 0; g < 3; ++g) {
+                    size_t count = groupInstanceStart[g + 1] - groupInstanceStart[g];
+                    if (count == 0) continue;
+                    const VisualObjectParams& fo = groups[g].objects[0];
+                    float baseColor[3] = {fo.colorTop.x, fo.colorLeft.y, fo.colorRight.z};
+                    if (onlyRGB) baseColor[0] = baseColor[1] = baseColor[2] = 1.0f;
+                    
+                    size_t bytes = count * sizeof(InstanceData);
+                    size_t offset = 0;
+                    void* dst = instanceRing.allocate(bytes, sizeof(InstanceData), offset);
+                    if (!dst) break;
+                    memcpy(dst, allInstances.data() + groupInstanceStart[g], bytes);
+                    instanceRing.commit();
+                    
+                    gpuFractal.bind(fo.shapeType, levels, fo.triSize, baseColor, currentTime, (float)width / (float)height);
+                    bindInstanceAttributes(instanceRing.buffer(), offset);
+                    if (GpuFractal::primitive(fo.shapeType) == GL_LINES) setLineState();
+                    gpuFractal.draw((GLsizei)count);
+                }
+            } else {
+                // OPTIMIZATION: Update cached fractal VBO if needed
+                float colors[9] = {colorTopArr[0], colorTopArr[1], colorTopArr[2],
+                                  colorLeftArr[0], colorLeftArr[1], colorLeftArr[2],
+                                  colorRightArr[0], colorRightArr[1], colorRightArr[2]};
             
-            for (int i = 0; i < 9; ++i) {
-                if (fabs(currentCachedVBO->colors[i] - colors[i]) > 0.001f) {
+                // A stale handle (evicted or removed entry) resolves to nullptr
+                CachedVBO* currentCachedVBO = geometryCache.get(currentGeometry);
+                bool needNewVBO = false;
+                if (!currentCachedVBO || 
+                    currentCachedVBO->shapeType != meshObj.shapeType ||
+                    currentCachedVBO->size != meshObj.triSize ||
+                    currentCachedVBO->fractalDepth != fractalDepth) {
                     needNewVBO = true;
-                    break;
                 }
-            }
             
-            if (needNewVBO) {
-                currentCachedVBO = findOrCreateCachedVBO(
-                    groups[0].objects[0].shapeType,
-                    groups[0].objects[0].triSize,
-                    colors,
-                    groups[0].objects[0].nSegments,
-                    fractalMode,
-                    fractalDepth
-                );
-            }
+                for (int i = 0; i < 9 && currentCachedVBO; ++i) {
+                    if (fabs(currentCachedVBO->colors[i] - colors[i]) > 0.001f) {
+                        needNewVBO = true;
+                        break;
+                    }
+                }
             
-            // OPTIMIZATION: Render all instances in one batch
-            if (currentCachedVBO && !allInstances.empty()) {
-                renderBatch(currentCachedVBO, allInstances, shaderProgram, (float)width / (float)height);
+                if (needNewVBO) {
+                    currentGeometry = findOrCreateCachedVBO(
+                        meshObj.shapeType,
+                        meshObj.triSize,
+                        colors,
+                        meshObj.nSegments,
+                        true,
+                        fractalDepth,
+                        currentTime
+                    );
+                    currentCachedVBO = geometryCache.get(currentGeometry);
+                }
+            
+                // OPTIMIZATION: Render all instances in one batch
+                if (currentCachedVBO) {
+                    MeshRange fractalMesh;
+                    fractalMesh.count = currentCachedVBO->vertexCount;
+                    fractalMesh.mode = currentCachedVBO->primitive;
+                    renderBatch(currentCachedVBO->VAO, fractalMesh, allInstances, shaderProgram, (float)width / (float)height);
+                }
             }
         }
+        gpuTimer.end();
 
+        framePhases.next("Pausa FPS");
         // FPS custom: pacing preciso con steady_clock para evitar jitter
         if (fpsMode == FPS_CUSTOM && customFps > 0) {
             using clock = std::chrono::steady_clock;
@@ -3192,6 +3680,7 @@ int main() {
             nextFrame += std::chrono::duration_cast<clock::duration>(frameDur);
         }
 
+        framePhases.next("UI");
         // AUDIO TEST MODE WINDOW: Para probar audio reactivo fácilmente
         if (uiVisibility.showAudioTestMode) {
             ImGui::SetNextWindowPos(ImVec2(width - 400, height - 400), ImGuiCond_Once);
@@ -3289,7 +3778,7 @@ int main() {
             lastFractalToggleTime = currentTime;
             
             // Forzar regeneración de VBO cuando cambia el modo fractal
-            currentCachedVBO = nullptr;
+            currentGeometry = GeometryHandle();
         }
         
         // --- NUEVO: Efecto Glitch ---
@@ -3311,8 +3800,13 @@ int main() {
                 glitchScaleX = 1.0f + (frand() - 0.5f) * glitchIntensity;
                 glitchScaleY = 1.0f + (frand() - 0.5f) * glitchIntensity;
                 
-                // Aplicar delay
-                std::this_thread::sleep_for(std::chrono::milliseconds((int)(glitchDelay * 1000)));
+                // Aplicar delay (fase propia: es una pausa buscada, no un hitch)
+                framePhases.next("Pausa glitch");
+                {
+                    PROFILE_ZONE("Glitch sleep_for");
+                    std::this_thread::sleep_for(std::chrono::milliseconds((int)(glitchDelay * 1000)));
+                }
+                framePhases.next("UI");
             } else {
                 glitchActive = false;
             }
@@ -3320,10 +3814,10 @@ int main() {
         
         // --- NUEVO: Randomización basada en frecuencias de música ---
         if (frequencyBasedRandomization && audioReactive) {
-            // Randomización por Bass
-            if (currentAudio.bass > bassRandomizationThreshold && 
-                currentTime - lastBassRandomizeTime >= frequencyRandomizeCooldown) {
-                // Randomizar parámetros basados en bass
+            // Randomización por Kick
+            if (currentAudio.drumHit[DRUM_KICK] && currentAudio.drumVelocity[DRUM_KICK] >= kickVelocityThreshold && 
+                currentTime - lastKickRandomizeTime >= frequencyRandomizeCooldown) {
+                // Randomizar tamaño y velocidad con el kick
                 for (int g = 0; g < 3; ++g) {
                     if (randomAffect.triSize) {
                         groups[g].objects[0].triSize = randomLimits.sizeMin + 
@@ -3334,13 +3828,13 @@ int main() {
                             frand() * (randomLimits.speedMax - randomLimits.speedMin);
                     }
                 }
-                lastBassRandomizeTime = currentTime;
+                lastKickRandomizeTime = currentTime;
             }
             
-            // Randomización por Mid
-            if (currentAudio.mid > midRandomizationThreshold && 
-                currentTime - lastMidRandomizeTime >= frequencyRandomizeCooldown) {
-                // Randomizar colores basados en mid
+            // Randomización por Snare
+            if (currentAudio.drumHit[DRUM_SNARE] && currentAudio.drumVelocity[DRUM_SNARE] >= snareVelocityThreshold && 
+                currentTime - lastSnareRandomizeTime >= frequencyRandomizeCooldown) {
+                // Randomizar colores con el snare
                 for (int g = 0; g < 3; ++g) {
                     if (randomAffect.colorTop) {
                         groups[g].objects[0].colorTop = ImVec4(frand(), frand(), frand(), 1.0f);
@@ -3352,13 +3846,13 @@ int main() {
                         groups[g].objects[0].colorRight = ImVec4(frand(), frand(), frand(), 1.0f);
                     }
                 }
-                lastMidRandomizeTime = currentTime;
+                lastSnareRandomizeTime = currentTime;
             }
             
-            // Randomización por Treble
-            if (currentAudio.treble > trebleRandomizationThreshold && 
-                currentTime - lastTrebleRandomizeTime >= frequencyRandomizeCooldown) {
-                // Randomizar posición y escala basados en treble
+            // Randomización por Hi-hat
+            if (currentAudio.drumHit[DRUM_HAT] && currentAudio.drumVelocity[DRUM_HAT] >= hatVelocityThreshold && 
+                currentTime - lastHatRandomizeTime >= frequencyRandomizeCooldown) {
+                // Randomizar posición y escala con el hi-hat
                 for (int g = 0; g < 3; ++g) {
                     if (randomAffect.translateX) {
                         groups[g].objects[0].translateX = randomLimits.txMin + 
@@ -3377,7 +3871,7 @@ int main() {
                             frand() * (randomLimits.syMax - randomLimits.syMin);
                     }
                 }
-                lastTrebleRandomizeTime = currentTime;
+                lastHatRandomizeTime = currentTime;
             }
         }
         
@@ -3434,7 +3928,7 @@ int main() {
             // Apply audio preset if audio reactive
             if (randomPreset.audioReactive && randomPreset.audioPresetIndex < audioPresets.size()) {
                 for (int g = 0; g < 3; ++g) {
-                    applyAudioPreset(audioGroups[g], audioPresets[randomPreset.audioPresetIndex]);
+                    applyAudioPreset(g, audioPresets[randomPreset.audioPresetIndex]);
                 }
             }
             
@@ -3445,7 +3939,7 @@ int main() {
             }
             
             // Force VBO regeneration
-            currentCachedVBO = nullptr;
+            currentGeometry = GeometryHandle();
             
             // Update last randomize time
             lastPresetRandomizeTime = currentTime;
@@ -3507,7 +4001,7 @@ int main() {
                 // Apply audio preset if audio reactive
                 if (randomPreset.audioReactive && randomPreset.audioPresetIndex < audioPresets.size()) {
                     for (int g = 0; g < 3; ++g) {
-                        applyAudioPreset(audioGroups[g], audioPresets[randomPreset.audioPresetIndex]);
+                        applyAudioPreset(g, audioPresets[randomPreset.audioPresetIndex]);
                     }
                 }
                 
@@ -3518,7 +4012,7 @@ int main() {
                 }
                 
                 // Force VBO regeneration
-                currentCachedVBO = nullptr;
+                currentGeometry = GeometryHandle();
                 
                 ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "✅ Preset aleatorio aplicado: %s", randomPreset.name.c_str());
             }
@@ -3595,7 +4089,7 @@ int main() {
                     
                     if (randomPreset.audioReactive && randomPreset.audioPresetIndex < audioPresets.size()) {
                         for (int g = 0; g < 3; ++g) {
-                            applyAudioPreset(audioGroups[g], audioPresets[randomPreset.audioPresetIndex]);
+                            applyAudioPreset(g, audioPresets[randomPreset.audioPresetIndex]);
                         }
                     }
                     
@@ -3605,7 +4099,7 @@ int main() {
                     }
                 }
                 
-                currentCachedVBO = nullptr;
+                currentGeometry = GeometryHandle();
                 ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "✅ 3 presets aleatorios aplicados!");
             }
             
@@ -3680,7 +4174,7 @@ int main() {
                     // Apply audio preset if audio reactive
                     if (preset.audioReactive && preset.audioPresetIndex < audioPresets.size()) {
                         for (int g = 0; g < 3; ++g) {
-                            applyAudioPreset(audioGroups[g], audioPresets[preset.audioPresetIndex]);
+                            applyAudioPreset(g, audioPresets[preset.audioPresetIndex]);
                         }
                     }
                     
@@ -3691,7 +4185,7 @@ int main() {
                     }
                     
                     // Force VBO regeneration
-                    currentCachedVBO = nullptr;
+                    currentGeometry = GeometryHandle();
                     
                     ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "✅ Preset aplicado!");
                 }
@@ -3713,9 +4207,9 @@ int main() {
                 // Apply first two presets
                 animationPresets[0].apply(groups, autoRotate, randomize, audioReactive, bpm, groupSeparation, randomLimits, randomAffect);
                 for (int g = 0; g < 3; ++g) {
-                    applyAudioPreset(audioGroups[g], audioPresets[3]); // Full Spectrum
+                    applyAudioPreset(g, audioPresets[3]); // Full Spectrum
                 }
-                currentCachedVBO = nullptr;
+                currentGeometry = GeometryHandle();
             }
             ImGui::SameLine();
             
@@ -3724,18 +4218,18 @@ int main() {
                 fractalMode = true;
                 fractalDepth = 4.0f;
                 for (int g = 0; g < 3; ++g) {
-                    applyAudioPreset(audioGroups[g], audioPresets[6]); // Chaos Mode
+                    applyAudioPreset(g, audioPresets[6]); // Chaos Mode
                 }
-                currentCachedVBO = nullptr;
+                currentGeometry = GeometryHandle();
             }
             ImGui::SameLine();
             
             if (ImGui::Button("⚡ Líneas")) {
                 animationPresets[3].apply(groups, autoRotate, randomize, audioReactive, bpm, groupSeparation, randomLimits, randomAffect);
                 for (int g = 0; g < 3; ++g) {
-                    applyAudioPreset(audioGroups[g], audioPresets[4]); // Full Spectrum
+                    applyAudioPreset(g, audioPresets[4]); // Full Spectrum
                 }
-                currentCachedVBO = nullptr;
+                currentGeometry = GeometryHandle();
             }
             
             ImGui::SameLine();
@@ -3744,18 +4238,18 @@ int main() {
                 fractalMode = true;
                 fractalDepth = 3.0f;
                 for (int g = 0; g < 3; ++g) {
-                    applyAudioPreset(audioGroups[g], audioPresets[6]); // Chaos Mode
+                    applyAudioPreset(g, audioPresets[6]); // Chaos Mode
                 }
-                currentCachedVBO = nullptr;
+                currentGeometry = GeometryHandle();
             }
             
             ImGui::SameLine();
             if (ImGui::Button("🧠 Neural")) {
                 animationPresets[10].apply(groups, autoRotate, randomize, audioReactive, bpm, groupSeparation, randomLimits, randomAffect);
                 for (int g = 0; g < 3; ++g) {
-                    applyAudioPreset(audioGroups[g], audioPresets[0]); // Bass Dominant
+                    applyAudioPreset(g, audioPresets[0]); // Bass Dominant
                 }
-                currentCachedVBO = nullptr;
+                currentGeometry = GeometryHandle();
             }
             
             ImGui::SameLine();
@@ -3764,9 +4258,9 @@ int main() {
                 fractalMode = true;
                 fractalDepth = 3.5f;
                 for (int g = 0; g < 3; ++g) {
-                    applyAudioPreset(audioGroups[g], audioPresets[6]); // Chaos Mode
+                    applyAudioPreset(g, audioPresets[6]); // Chaos Mode
                 }
-                currentCachedVBO = nullptr;
+                currentGeometry = GeometryHandle();
             }
             
             ImGui::Separator();
@@ -3796,14 +4290,67 @@ int main() {
             ImGui::End();
         }
 
+        // GPU TIMING OVERLAY: resultados de hace unos frames, sin esperar a la GPU
+        if (!performanceMode && showTimingOverlay) {
+            ImGui::SetNextWindowPos(ImVec2((float)width - 330.0f, 10.0f), ImGuiCond_Always);
+            ImGui::SetNextWindowBgAlpha(0.6f);
+            ImGui::Begin("⏱️ Tiempos", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoInputs);
+            if (!gpuTimer.gpuAvailable()) ImGui::TextDisabled("(sin timer queries: solo CPU)");
+            if (ImGui::BeginTable("tiempos", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+                ImGui::TableSetupColumn("Pasada");
+                ImGui::TableSetupColumn("GPU ms");
+                ImGui::TableSetupColumn("GPU máx");
+                ImGui::TableSetupColumn("CPU ms");
+                ImGui::TableHeadersRow();
+                float gpuTotal = 0.0f, cpuTotal = 0.0f;
+                for (const GpuTimer::PassStats& pass : gpuTimer.passes()) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn(); ImGui::Text("%s", pass.name.c_str());
+                    ImGui::TableNextColumn(); ImGui::Text("%.2f", pass.gpuAvgMs);
+                    ImGui::TableNextColumn(); ImGui::Text("%.2f", pass.gpuMaxMs);
+                    ImGui::TableNextColumn(); ImGui::Text("%.2f", pass.cpuAvgMs);
+                    gpuTotal += pass.gpuAvgMs;
+                    cpuTotal += pass.cpuAvgMs;
+                }
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn(); ImGui::Text("Total");
+                ImGui::TableNextColumn(); ImGui::Text("%.2f", gpuTotal);
+                ImGui::TableNextColumn(); ImGui::Text("-");
+                ImGui::TableNextColumn(); ImGui::Text("%.2f", cpuTotal);
+                ImGui::EndTable();
+            }
+            ImGui::Text("Frame: %.2f ms | descartados: %llu", 1000.0f / std::max(1.0f, ImGui::GetIO().Framerate),
+                        (unsigned long long)gpuTimer.droppedFrames());
+            ImGui::End();
+        }
+
+        framePhases.next("ImGui render");
         // Render ImGui (omitir en modo rendimiento)
         if (!performanceMode) {
+            gpuTimer.begin("ImGui");
             ImGui::Render();
             ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+            gpuTimer.end();
         }
 
+        framePhases.next("Presentación");
+        // Fence this frame's instance region before presenting
+        instanceRing.endFrame();
+        float swapStart = glfwGetTime();
+        latencyModel.measure(LATENCY_RENDER, swapStart - frameStartTime);
+        gpuTimer.begin("Presentación");
         glfwSwapBuffers(window);
+        gpuTimer.end();
+        latencyModel.measure(LATENCY_SWAP, (float)glfwGetTime() - swapStart);
         glfwPollEvents();
+        
+        // FLIGHT RECORDER: siempre activo, unos pocos stores por frame
+        framePhases.end();
+        static uint64_t lastCacheMisses = 0;
+        uint64_t cacheMisses = geometryCache.misses();
+        flightRecorder.record(glfwGetTime(), framePhases, audio ? audio->getBufferFill() : 0.0f,
+                              (uint32_t)(cacheMisses - lastCacheMisses));
+        lastCacheMisses = cacheMisses;
     } // End of main while loop
 
     // Cleanup ImGui
@@ -3812,14 +4359,18 @@ int main() {
     ImGui::DestroyContext();
 
     // OPTIMIZATION: Cleanup all cached VBOs
-    for (auto& cached : vboCache) {
-        if (cached.VAO) glDeleteVertexArrays(1, &cached.VAO);
-        if (cached.VBO) glDeleteBuffers(1, &cached.VBO);
-        if (cached.instanceVBO) glDeleteBuffers(1, &cached.instanceVBO);
-    }
-    vboCache.clear();
+    geometryCache.clear();
+    meshLibrary.destroy();
+    gpuFractal.destroy();
+    fractalEngine.shutdown();
+    escapePass.destroy();
+    sdfShapes.destroy();
+    lineRenderer.destroy();
+    instanceRing.destroy();
     
-    glDeleteProgram(shaderProgram);
+    shaderManager.destroy();
+    gpuTimer.stopCsv();
+    gpuTimer.destroy();
     glfwDestroyWindow(window);
     glfwTerminate();
     return 0;
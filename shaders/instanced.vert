@@ -0,0 +1,22 @@
+#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aColor;
+layout(location = 2) in vec2 aOffset;
+layout(location = 3) in float aAngle;
+layout(location = 4) in vec2 aScale;
+layout(location = 5) in vec4 aColorTop;   // per-instance corner colors (RGBA8)
+layout(location = 6) in vec4 aColorLeft;
+layout(location = 7) in vec4 aColorRight;
+out vec3 vColor;
+uniform float uAspect;
+uniform float uTime;
+void main() {
+    float s = sin(aAngle);
+    float c = cos(aAngle);
+    mat2 rot = mat2(c, -s, s, c);
+    vec2 pos = rot * (aPos.xy * aScale) + aOffset;
+    pos.x /= uAspect;
+    gl_Position = vec4(pos, aPos.z, 1.0);
+    // aColor holds the weights of the three corner colors baked into the mesh
+    vColor = aColor.x * aColorTop.rgb + aColor.y * aColorLeft.rgb + aColor.z * aColorRight.rgb;
+}
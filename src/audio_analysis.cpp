@@ -0,0 +1,186 @@
+#include "audio_analysis.h"
+#include "modulation_matrix.h"
+#include "profiler.h"
+#include <cmath>
+#include <algorithm>
+
+namespace {
+    // Band edges in Hz: bass, low mid, mid, high mid, treble
+    const float BAND_EDGES[6] = {20.0f, 150.0f, 400.0f, 2000.0f, 6000.0f, 20000.0f};
+    // Chroma range; the lower edge is raised until bins resolve semitones
+    const float CHROMA_MIN_HZ = 55.0f;
+    const float CHROMA_MAX_HZ = 5000.0f;
+    const float SEMITONE_RATIO = 0.05946f; // 2^(1/12) - 1
+    const float ROLLOFF_FRACTION = 0.85f;
+    const float LOG_EPSILON = 1e-10f;
+
+    inline float finiteOrZero(float v) {
+        return std::isfinite(v) ? v : 0.0f;
+    }
+}
+
+AudioFeatureExtractor::AudioFeatureExtractor(float sampleRate)
+    : sampleRate(sampleRate) {}
+
+void AudioFeatureExtractor::setSampleRate(float sr) {
+    if (sr != sampleRate) {
+        sampleRate = sr;
+        tableSize = 0; // force rebuild
+    }
+}
+
+void AudioFeatureExtractor::rebuildTables(int n) {
+    tableSize = n;
+    float freqPerBin = sampleRate / (2.0f * n);
+    if (freqPerBin <= 0.0f) freqPerBin = 1.0f;
+
+    // Same inclusive ranges as the original analysis: neighbouring bands share
+    // their edge bin
+    int prevEnd = 0;
+    for (int b = 0; b < 5; ++b) {
+        int start = std::max(prevEnd, (int)(BAND_EDGES[b] / freqPerBin));
+        int end = std::min(n - 1, (int)(BAND_EDGES[b + 1] / freqPerBin));
+        start = std::max(prevEnd, std::min(n - 1, start));
+        end = std::max(start, std::min(n - 1, end));
+        bandStart[b] = start;
+        bandEnd[b] = end;
+        prevEnd = end;
+    }
+
+    // Below this a single bin spans more than a semitone
+    float chromaMinHz = std::max(CHROMA_MIN_HZ, freqPerBin / SEMITONE_RATIO);
+
+    binFreq.resize(n);
+    chromaClass.resize(n);
+    for (int i = 0; i < n; ++i) {
+        float hz = i * freqPerBin;
+        binFreq[i] = (float)i / n;
+        if (hz < chromaMinHz || hz > CHROMA_MAX_HZ) {
+            chromaClass[i] = -1;
+            continue;
+        }
+        // MIDI note 60 = C4, so note % 12 == 0 is C
+        int note = (int)std::lround(69.0f + 12.0f * std::log2(hz / 440.0f));
+        chromaClass[i] = (int8_t)(((note % 12) + 12) % 12);
+    }
+
+    prevSpectrum.assign(n, 0.0f);
+    cumulativeEnergy.resize(n);
+}
+
+void AudioFeatureExtractor::analyze(const std::vector<float>& spectrum, const std::vector<float>& samples,
+                                    AudioAnalysis& analysis) {
+    PROFILE_ZONE("Análisis de audio");
+    int n = spectrum.size();
+    if (n <= 0) {
+        // Reset analysis to safe values
+        analysis = AudioAnalysis();
+        return;
+    }
+    if (n != tableSize) rebuildTables(n);
+
+    float bandSum[5] = {};
+    float overallSum = 0.0f;
+    float peakValue = 0.0f;
+    float weightedFreq = 0.0f;
+    float energy = 0.0f;
+    float logEnergySum = 0.0f;
+    float fluxSum = 0.0f;
+    float chroma[12] = {};
+
+    // Every spectral feature is accumulated in this one loop
+    for (int i = 0; i < n; ++i) {
+        float value = finiteOrZero(spectrum[i]);
+
+        overallSum += value;
+        peakValue = std::max(peakValue, value);
+        for (int b = 0; b < 5; ++b) {
+            if (i >= bandStart[b] && i <= bandEnd[b]) bandSum[b] += value;
+        }
+
+        float power = value * value;
+        energy += power;
+        cumulativeEnergy[i] = energy;
+        logEnergySum += std::log(power + LOG_EPSILON);
+        weightedFreq += binFreq[i] * value;
+
+        float diff = value - prevSpectrum[i];
+        fluxSum += std::max(0.0f, diff);
+        prevSpectrum[i] = value;
+
+        int pc = chromaClass[i];
+        if (pc >= 0) chroma[pc] += power;
+    }
+
+    for (int b = 0; b < 5; ++b) {
+        int count = std::max(1, bandEnd[b] - bandStart[b] + 1);
+        bandSum[b] /= count;
+    }
+    analysis.bass = finiteOrZero(bandSum[0]);
+    analysis.lowMid = finiteOrZero(bandSum[1]);
+    analysis.mid = finiteOrZero(bandSum[2]);
+    analysis.highMid = finiteOrZero(bandSum[3]);
+    analysis.treble = finiteOrZero(bandSum[4]);
+    analysis.overall = finiteOrZero(overallSum / n);
+    analysis.peak = finiteOrZero(peakValue);
+    analysis.rms = overallSum > 0.0f ? finiteOrZero(std::sqrt(overallSum / n)) : 0.0f;
+
+    // Timbre
+    analysis.centroid = overallSum > 0.0f ? finiteOrZero(weightedFreq / overallSum) : 0.0f;
+    float meanPower = energy / n;
+    analysis.flatness = meanPower > LOG_EPSILON
+        ? std::min(1.0f, finiteOrZero(std::exp(logEnergySum / n) / meanPower)) : 0.0f;
+    analysis.flux = finiteOrZero(fluxSum / n);
+    if (energy > 0.0f) {
+        // cumulativeEnergy is sorted, so the rolloff bin is a binary search
+        float threshold = energy * ROLLOFF_FRACTION;
+        int bin = std::lower_bound(cumulativeEnergy.begin(), cumulativeEnergy.begin() + n, threshold)
+                  - cumulativeEnergy.begin();
+        analysis.rolloff = (float)std::min(bin, n - 1) / n;
+    } else {
+        analysis.rolloff = 0.0f;
+    }
+
+    // Harmony
+    float chromaMax = *std::max_element(chroma, chroma + 12);
+    for (int c = 0; c < 12; ++c) {
+        analysis.chroma[c] = chromaMax > 0.0f ? finiteOrZero(chroma[c] / chromaMax) : 0.0f;
+    }
+
+    // Zero-crossing rate from the time-domain block
+    int crossings = 0;
+    int m = samples.size();
+    for (int i = 1; i < m; ++i) {
+        crossings += (samples[i - 1] < 0.0f) != (samples[i] < 0.0f);
+    }
+    analysis.zcr = m > 1 ? (float)crossings / (m - 1) : 0.0f;
+}
+
+void fillModSources(const AudioAnalysis& analysis, float* sources) {
+    sources[MOD_SRC_BASS] = analysis.bass;
+    sources[MOD_SRC_LOW_MID] = analysis.lowMid;
+    sources[MOD_SRC_MID] = analysis.mid;
+    sources[MOD_SRC_HIGH_MID] = analysis.highMid;
+    sources[MOD_SRC_TREBLE] = analysis.treble;
+    sources[MOD_SRC_OVERALL] = analysis.overall;
+    sources[MOD_SRC_PEAK] = analysis.peak;
+    sources[MOD_SRC_RMS] = analysis.rms;
+    // C2..C6 mapped to 0-1
+    sources[MOD_SRC_PITCH] = analysis.pitchMidi > 0.0f
+        ? std::max(0.0f, std::min(1.0f, (analysis.pitchMidi - 36.0f) / 48.0f)) : 0.0f;
+    sources[MOD_SRC_PITCH_CONFIDENCE] = analysis.pitchConfidence;
+    sources[MOD_SRC_CENTROID] = analysis.centroid;
+    sources[MOD_SRC_FLATNESS] = analysis.flatness;
+    sources[MOD_SRC_ROLLOFF] = analysis.rolloff;
+    sources[MOD_SRC_FLUX] = analysis.flux;
+    sources[MOD_SRC_ZCR] = analysis.zcr;
+    for (int c = 0; c < 12; ++c) {
+        sources[MOD_SRC_CHROMA_C + c] = analysis.chroma[c];
+    }
+    for (int b = 0; b < 5; ++b) {
+        sources[MOD_SRC_ENV_BASS + b] = analysis.envelopePeak[b];
+    }
+    sources[MOD_SRC_KICK] = analysis.drum[0];
+    sources[MOD_SRC_SNARE] = analysis.drum[1];
+    sources[MOD_SRC_HAT] = analysis.drum[2];
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+// Audio analysis variables
+struct AudioAnalysis {
+    float bass = 0.0f;
+    float lowMid = 0.0f;
+    float mid = 0.0f;
+    float highMid = 0.0f;
+    float treble = 0.0f;
+    float overall = 0.0f;
+    float peak = 0.0f;
+    float rms = 0.0f;
+
+    // Monophonic pitch (PitchTracker); pitchHz holds the last voiced pitch
+    float pitchHz = 0.0f;
+    float pitchConfidence = 0.0f;
+    float pitchMidi = 0.0f;
+
+    // Timbre
+    float centroid = 0.0f;  // spectral centroid, fraction of Nyquist (0-1)
+    float flatness = 0.0f;  // 0 = tonal, 1 = noise
+    float rolloff = 0.0f;   // 85% energy frequency, fraction of Nyquist (0-1)
+    float flux = 0.0f;      // positive spectral change since the previous frame
+    float zcr = 0.0f;       // zero crossings per sample (0-1)
+
+    // Harmony: energy per pitch class (C, C#, ... B), strongest class = 1
+    float chroma[12] = {};
+
+    // Per-sample band envelopes from the capture thread (BandEnvelopeBank),
+    // same band order as above; envelopePeak holds transients for a while
+    float envelope[5] = {};
+    float envelopePeak[5] = {};
+
+    // Drum events (DrumClassifier, kick/snare/hat): hit during this frame, its
+    // velocity, and a hit envelope that decays between hits
+    bool drumHit[3] = {};
+    float drumVelocity[3] = {};
+    float drum[3] = {};
+};
+
+// Single pass feature extractor. Keeps the previous spectrum (for flux) and
+// per-bin lookup tables, which are rebuilt only when the FFT size or sample
+// rate changes.
+class AudioFeatureExtractor {
+public:
+    explicit AudioFeatureExtractor(float sampleRate = 48000.0f);
+    void setSampleRate(float sampleRate);
+
+    // spectrum: magnitudes of the first half of the FFT. samples: the
+    // time-domain block the spectrum was computed from (used for ZCR).
+    void analyze(const std::vector<float>& spectrum, const std::vector<float>& samples, AudioAnalysis& analysis);
+
+private:
+    void rebuildTables(int n);
+
+    float sampleRate;
+    int tableSize = 0;
+    int bandStart[5] = {};
+    int bandEnd[5] = {};
+    std::vector<float> binFreq;       // normalized frequency of each bin
+    std::vector<int8_t> chromaClass;  // pitch class of each bin, -1 if outside the tonal range
+    std::vector<float> prevSpectrum;
+    std::vector<float> cumulativeEnergy;
+};
+
+// Flatten the analysis into modulation matrix sources (see ModSource)
+void fillModSources(const AudioAnalysis& analysis, float* sources);
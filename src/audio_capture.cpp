@@ -1,4 +1,5 @@
 #include "audio_capture.h"
+#include "profiler.h"
 #include <pulse/simple.h>
 #include <pulse/error.h>
 #include <pulse/pulseaudio.h>
@@ -9,9 +10,15 @@
 #include <atomic>
 #include "utils/ring_buffer.h"
 #include <chrono>
+#include <algorithm>
+
+// Frames per read; small so the envelope followers publish every few ms
+static const int CAPTURE_CHUNK_FRAMES = 128;
 
 AudioCapture::AudioCapture(const char* device, int sample_rate, int channels, int block_size)
-    : s(nullptr), sample_rate(sample_rate), channels(channels), block_size(block_size), running(false) {
+    : s(nullptr), sample_rate(sample_rate), channels(channels), block_size(block_size), running(false),
+      envelopes((float)sample_rate), drums((float)sample_rate),
+      pitch((float)sample_rate), goertzel((float)sample_rate, block_size), lightweight(false) {
     pa_sample_spec ss;
     ss.format = PA_SAMPLE_S32LE;
     ss.rate = sample_rate;
@@ -22,7 +29,7 @@ AudioCapture::AudioCapture(const char* device, int sample_rate, int channels, in
     attr.tlength = block_size * channels * sizeof(int32_t);
     attr.prebuf = 0;
     attr.minreq = block_size * channels * sizeof(int32_t);
-    attr.fragsize = block_size * channels * sizeof(int32_t);
+    attr.fragsize = std::min(block_size, CAPTURE_CHUNK_FRAMES) * channels * sizeof(int32_t);
 
     int error;
     s = pa_simple_new(
@@ -51,14 +58,38 @@ void AudioCapture::stop() {
 }
 
 void AudioCapture::captureThreadFunc() {
-    std::vector<int32_t> block(block_size * channels);
+    const int chunk_frames = std::min(block_size, CAPTURE_CHUNK_FRAMES);
+    std::vector<int32_t> block(chunk_frames * channels);
+    std::vector<float> mono(chunk_frames);
+    profiler::setThreadName("Captura de audio");
     while (running) {
         if (!s) break;
         int error;
-        if (pa_simple_read(s, block.data(), block.size() * sizeof(int32_t), &error) < 0) {
+        int readResult;
+        {
+            PROFILE_ZONE("pa_simple_read");
+            readResult = pa_simple_read(s, block.data(), block.size() * sizeof(int32_t), &error);
+        }
+        if (readResult < 0) {
             std::cerr << "pa_simple_read() failed: " << pa_strerror(error) << std::endl;
             break;
         }
+        PROFILE_ZONE("Captura: bloque");
+        // Band envelopes run on every sample, before the FFT path sees the data
+        for (int f = 0; f < chunk_frames; ++f) {
+            float sum = 0.0f;
+            for (int c = 0; c < channels; ++c) sum += (float)block[f * channels + c];
+            mono[f] = sum / channels / 2147483648.0f;
+        }
+        if (lightweight.load(std::memory_order_relaxed)) {
+            // OPTIMIZATION: Goertzel bands only; nobody drains the ring buffer in this mode
+            goertzel.process(mono.data(), chunk_frames);
+            continue;
+        }
+        envelopes.process(mono.data(), chunk_frames);
+        drums.process(envelopes.levels(), chunk_frames);
+        pitch.process(mono.data(), chunk_frames);
+
         // Push samples into ring buffer
         for (size_t i = 0; i < block.size(); ++i) {
             while (!ring_buffer.push(block[i]) && running) {
@@ -68,6 +99,11 @@ void AudioCapture::captureThreadFunc() {
     }
 }
 
+float AudioCapture::getBufferLatency() const {
+    int chunk_frames = std::min(block_size, CAPTURE_CHUNK_FRAMES);
+    return (chunk_frames + block_size * 0.5f) / sample_rate;
+}
+
 // Get the latest block of samples, returns false if not enough data
 bool AudioCapture::getLatestBlock(std::vector<int32_t>& out) {
     if (out.size() != block_size * channels) out.resize(block_size * channels);
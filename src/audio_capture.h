@@ -2,6 +2,10 @@
 #include <vector>
 #include <pulse/simple.h>
 #include "utils/ring_buffer.h"
+#include "band_envelope.h"
+#include "drum_classifier.h"
+#include "pitch_tracker.h"
+#include "goertzel_bands.h"
 #include <thread>
 #include <atomic>
 
@@ -15,6 +19,24 @@ public:
     bool getLatestBlock(std::vector<int32_t>& out);
     int getSampleRate() const { return sample_rate; }
     int getChannels() const { return channels; }
+    // Latest per-band envelope and peak-hold levels (ENVELOPE_BANDS each)
+    void readBandEnvelopes(float* envelope, float* peak) const { envelopes.read(envelope, peak); }
+    // Kick/snare/hat events detected on the capture thread, returns false when none is pending
+    bool popDrumEvent(DrumEvent& event) { return drums.popEvent(event); }
+    void setDrumSensitivity(float sensitivity) { drums.setSensitivity(sensitivity); }
+    // Monophonic pitch, tracked on the capture thread every `hop` samples
+    void readPitch(float& hz, float& confidence, float& midi) const { pitch.read(hz, confidence, midi); }
+    void setPitchHop(int samples) { pitch.setHop(samples); }
+    float getPitchAnalysisMs() const { return pitch.lastAnalysisMs(); }
+    // Lightweight mode: the capture thread only runs the Goertzel bands; envelopes,
+    // drums, pitch and the sample ring buffer (getLatestBlock) are skipped
+    void setLightweight(bool enabled) { lightweight.store(enabled, std::memory_order_relaxed); }
+    void readGoertzelBands(float* bands, float& overall, float& peak) const { goertzel.read(bands, overall, peak); }
+    // Age of the audio at the centre of the latest analysis block: one capture
+    // chunk plus half a block, in seconds
+    float getBufferLatency() const;
+    // Fraction of the sample ring buffer waiting to be read (0 empty, 1 full)
+    float getBufferFill() const { return (float)ring_buffer.size() / (float)ring_buffer.capacity(); }
 private:
     void captureThreadFunc();
     pa_simple* s;
@@ -24,4 +46,9 @@ private:
     std::thread capture_thread;
     std::atomic<bool> running;
     RingBuffer<int32_t, 16384> ring_buffer; // 16K samples buffer
+    BandEnvelopeBank envelopes; // updated per sample on the capture thread
+    DrumClassifier drums;       // fed by the envelopes after every chunk
+    PitchTracker pitch;
+    GoertzelBandBank goertzel;  // performance mode only
+    std::atomic<bool> lightweight;
 }; 
\ No newline at end of file
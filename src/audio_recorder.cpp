@@ -0,0 +1,141 @@
+#include "audio_recorder.h"
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+    const char MAGIC[4] = {'V', 'C', 'A', 'R'};
+    const uint32_t VERSION = 1;
+
+    size_t frameBytes(uint32_t bins) {
+        return sizeof(double) + sizeof(AudioAnalysis) + bins * sizeof(float);
+    }
+}
+
+bool AudioRecorder::start(const std::string& path, int spectrumBins, float sampleRate) {
+    stop();
+    file = fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "No se pudo crear la grabación: " << path << std::endl;
+        return false;
+    }
+    bins = (uint32_t)std::max(0, spectrumBins);
+    frameCount = 0;
+    frameBuffer.assign(frameBytes(bins), 0);
+
+    AudioRecordingHeader header = {};
+    memcpy(header.magic, MAGIC, 4);
+    header.version = VERSION;
+    header.analysisSize = sizeof(AudioAnalysis);
+    header.spectrumBins = bins;
+    header.sampleRate = sampleRate;
+    fwrite(&header, sizeof(header), 1, file);
+    return true;
+}
+
+void AudioRecorder::write(double timestamp, const AudioAnalysis& analysis, const std::vector<float>& spectrum) {
+    if (!file) return;
+    // One fwrite per frame into stdio's buffer
+    char* out = frameBuffer.data();
+    memcpy(out, &timestamp, sizeof(double));
+    memcpy(out + sizeof(double), &analysis, sizeof(AudioAnalysis));
+    float* spec = (float*)(out + sizeof(double) + sizeof(AudioAnalysis));
+    size_t n = std::min<size_t>(bins, spectrum.size());
+    memcpy(spec, spectrum.data(), n * sizeof(float));
+    std::fill(spec + n, spec + bins, 0.0f);
+    fwrite(out, frameBuffer.size(), 1, file);
+    ++frameCount;
+}
+
+void AudioRecorder::stop() {
+    if (!file) return;
+    // Patch the frame count into the header
+    fseek(file, offsetof(AudioRecordingHeader, frameCount), SEEK_SET);
+    fwrite(&frameCount, sizeof(frameCount), 1, file);
+    fclose(file);
+    file = nullptr;
+}
+
+bool AudioReplay::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "No se pudo abrir la grabación: " << path << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(AudioRecordingHeader)) {
+        ::close(fd);
+        return false;
+    }
+    void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) return false;
+
+    AudioRecordingHeader header;
+    memcpy(&header, mapped, sizeof(header));
+    if (memcmp(header.magic, MAGIC, 4) != 0 || header.version != VERSION ||
+        header.analysisSize != sizeof(AudioAnalysis)) {
+        std::cerr << "Grabación incompatible: " << path << std::endl;
+        munmap(mapped, st.st_size);
+        return false;
+    }
+
+    data = (const char*)mapped;
+    mappedSize = st.st_size;
+    bins = header.spectrumBins;
+    frameSize = frameBytes(bins);
+    // A recording that was not closed cleanly still replays up to its last full frame
+    size_t available = (mappedSize - sizeof(AudioRecordingHeader)) / frameSize;
+    frameCount = header.frameCount > 0 ? std::min<size_t>(header.frameCount, available) : available;
+    madvise(mapped, mappedSize, MADV_SEQUENTIAL);
+    return true;
+}
+
+void AudioReplay::close() {
+    if (data) munmap((void*)data, mappedSize);
+    data = nullptr;
+    mappedSize = 0;
+    frameCount = 0;
+}
+
+double AudioReplay::timestampAt(size_t index) const {
+    double t;
+    memcpy(&t, data + sizeof(AudioRecordingHeader) + index * frameSize, sizeof(double));
+    return t;
+}
+
+double AudioReplay::duration() const {
+    return frameCount > 0 ? timestampAt(frameCount - 1) : 0.0;
+}
+
+size_t AudioReplay::frameAt(double timestamp) const {
+    if (frameCount == 0) return 0;
+    size_t lo = 0, hi = frameCount;
+    while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if (timestampAt(mid) <= timestamp) lo = mid;
+        else hi = mid;
+    }
+    return lo;
+}
+
+float AudioReplay::frameDelta(size_t index) const {
+    if (frameCount < 2) return 0.0f;
+    index = std::max<size_t>(1, std::min(index, frameCount - 1));
+    return (float)std::max(0.0, timestampAt(index) - timestampAt(index - 1));
+}
+
+void AudioReplay::read(size_t index, AudioAnalysis& analysis, std::vector<float>& spectrum) const {
+    if (frameCount == 0) return;
+    index = std::min(index, frameCount - 1);
+    const char* frame = data + sizeof(AudioRecordingHeader) + index * frameSize;
+    memcpy(&analysis, frame + sizeof(double), sizeof(AudioAnalysis));
+    const char* spec = frame + sizeof(double) + sizeof(AudioAnalysis);
+    spectrum.resize(bins);
+    memcpy(spectrum.data(), spec, bins * sizeof(float));
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "audio_analysis.h"
+
+// Binary timeline of analysis frames (.vcar):
+//   header | frame 0 | frame 1 | ...
+//   frame = double timestamp (s) | AudioAnalysis | float spectrum[spectrumBins]
+// Frames have a fixed size, so replay can seek by index or timestamp. The
+// AudioAnalysis layout is stored in the header and recordings made with a
+// different layout are rejected.
+struct AudioRecordingHeader {
+    char magic[4];          // "VCAR"
+    uint32_t version;
+    uint32_t analysisSize;  // sizeof(AudioAnalysis) when recorded
+    uint32_t spectrumBins;
+    float sampleRate;
+    uint32_t reserved;
+    uint64_t frameCount;    // written when the recording is closed
+};
+
+class AudioRecorder {
+public:
+    ~AudioRecorder() { stop(); }
+
+    bool start(const std::string& path, int spectrumBins, float sampleRate);
+    void write(double timestamp, const AudioAnalysis& analysis, const std::vector<float>& spectrum);
+    void stop();
+
+    bool isRecording() const { return file != nullptr; }
+    uint64_t frames() const { return frameCount; }
+    uint32_t spectrumBins() const { return bins; }
+
+private:
+    FILE* file = nullptr;
+    uint32_t bins = 0;
+    uint64_t frameCount = 0;
+    std::vector<char> frameBuffer;
+};
+
+// Memory-mapped reader for recordings made with AudioRecorder
+class AudioReplay {
+public:
+    ~AudioReplay() { close(); }
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return data != nullptr; }
+    size_t frames() const { return frameCount; }
+    double duration() const;
+
+    // Index of the last frame at or before `timestamp` (binary search)
+    size_t frameAt(double timestamp) const;
+    // Recorded time step that led to frame `index` (frame 0 uses the next step)
+    float frameDelta(size_t index) const;
+    // Copies frame `index` into the analysis and spectrum used by the renderer
+    void read(size_t index, AudioAnalysis& analysis, std::vector<float>& spectrum) const;
+
+private:
+    double timestampAt(size_t index) const;
+
+    const char* data = nullptr;
+    size_t mappedSize = 0;
+    size_t frameSize = 0;
+    size_t frameCount = 0;
+    uint32_t bins = 0;
+};
@@ -0,0 +1,89 @@
+#include "band_envelope.h"
+#include <cmath>
+#include <algorithm>
+
+namespace {
+    // Band edges in Hz, matching the FFT bands
+    const float BAND_EDGES[ENVELOPE_BANDS + 1] = {20.0f, 150.0f, 400.0f, 2000.0f, 6000.0f, 20000.0f};
+
+    // One-pole coefficient for a time constant in seconds
+    float timeCoef(float seconds, float sampleRate) {
+        if (seconds <= 0.0f) return 0.0f;
+        return std::exp(-1.0f / (seconds * sampleRate));
+    }
+}
+
+BandEnvelopeBank::BandEnvelopeBank(float sampleRate)
+    : sampleRate(sampleRate) {
+    for (int b = 0; b < ENVELOPE_BANDS; ++b) {
+        publishedEnvelope[b].store(0.0f, std::memory_order_relaxed);
+        publishedPeak[b].store(0.0f, std::memory_order_relaxed);
+    }
+    designFilters();
+    setTimes(0.001f, 0.1f, 0.05f, 0.2f);
+}
+
+void BandEnvelopeBank::designFilters() {
+    // RBJ band-pass with 0 dB peak gain, centred on the geometric mean of each band
+    for (int b = 0; b < ENVELOPE_BANDS; ++b) {
+        float lo = BAND_EDGES[b];
+        float hi = std::min(BAND_EDGES[b + 1], 0.45f * sampleRate);
+        float fc = std::sqrt(lo * hi);
+        float q = fc / std::max(1.0f, hi - lo);
+
+        float w0 = 2.0f * 3.14159265f * fc / sampleRate;
+        float alpha = std::sin(w0) / (2.0f * q);
+        float a0 = 1.0f + alpha;
+        b0[b] = alpha / a0;
+        b2[b] = -alpha / a0;
+        a1[b] = -2.0f * std::cos(w0) / a0;
+        a2[b] = (1.0f - alpha) / a0;
+    }
+    // Padding lanes keep zero coefficients and always output silence
+}
+
+void BandEnvelopeBank::setTimes(float attack, float release, float peakHold, float peakRelease) {
+    attackCoef = timeCoef(attack, sampleRate);
+    releaseCoef = timeCoef(release, sampleRate);
+    peakReleaseCoef = timeCoef(peakRelease, sampleRate);
+    peakHoldSamples = peakHold * sampleRate;
+}
+
+void BandEnvelopeBank::process(const float* samples, int count) {
+    const float attack = attackCoef;
+    const float release = releaseCoef;
+    const float peakRelease = peakReleaseCoef;
+    const float holdSamples = peakHoldSamples;
+
+    for (int s = 0; s < count; ++s) {
+        const float x = samples[s];
+        // Fixed-width inner loop over the padded lanes; selects instead of
+        // branches so it compiles to one vector pass per sample
+        for (int l = 0; l < ENVELOPE_LANES; ++l) {
+            float y = b0[l] * x + z1[l];
+            z1[l] = z2[l] - a1[l] * y;
+            z2[l] = b2[l] * x - a2[l] * y;
+
+            float level = std::fabs(y);
+            float coef = level > env[l] ? attack : release;
+            env[l] = level + (env[l] - level) * coef;
+
+            bool newPeak = env[l] >= peak[l];
+            float decayed = hold[l] > 0.0f ? peak[l] : peak[l] * peakRelease;
+            peak[l] = newPeak ? env[l] : decayed;
+            hold[l] = newPeak ? holdSamples : hold[l] - 1.0f;
+        }
+    }
+
+    for (int b = 0; b < ENVELOPE_BANDS; ++b) {
+        publishedEnvelope[b].store(env[b], std::memory_order_relaxed);
+        publishedPeak[b].store(peak[b], std::memory_order_relaxed);
+    }
+}
+
+void BandEnvelopeBank::read(float* envelope, float* peakOut) const {
+    for (int b = 0; b < ENVELOPE_BANDS; ++b) {
+        envelope[b] = publishedEnvelope[b].load(std::memory_order_relaxed);
+        peakOut[b] = publishedPeak[b].load(std::memory_order_relaxed);
+    }
+}
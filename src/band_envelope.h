@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+
+// Same five bands as AudioAnalysis: bass, low mid, mid, high mid, treble
+const int ENVELOPE_BANDS = 5;
+// Bands are padded to a full AVX register so the per-sample loop vectorizes
+const int ENVELOPE_LANES = 8;
+
+// Per-band band-pass filters followed by envelope followers with peak hold,
+// run per sample on the capture thread. The renderer reads the latest
+// published levels at whatever rate it runs, so a transient that falls
+// between two FFT blocks is still seen on the next frame.
+class BandEnvelopeBank {
+public:
+    explicit BandEnvelopeBank(float sampleRate = 48000.0f);
+
+    // Times in seconds
+    void setTimes(float attack, float release, float peakHold, float peakRelease);
+
+    // Capture thread: filter a block of mono samples and publish the levels
+    void process(const float* samples, int count);
+
+    // Any thread: latest published levels (ENVELOPE_BANDS values each)
+    void read(float* envelope, float* peak) const;
+    // Capture thread only: current envelope levels without going through the atomics
+    const float* levels() const { return env; }
+
+private:
+    void designFilters();
+
+    float sampleRate;
+    float attackCoef = 0.0f;
+    float releaseCoef = 0.0f;
+    float peakReleaseCoef = 0.0f;
+    float peakHoldSamples = 0.0f;
+
+    // Biquad band-pass (transposed direct form II), one lane per band
+    alignas(32) float b0[ENVELOPE_LANES] = {};
+    alignas(32) float b2[ENVELOPE_LANES] = {}; // b1 is zero for a band-pass
+    alignas(32) float a1[ENVELOPE_LANES] = {};
+    alignas(32) float a2[ENVELOPE_LANES] = {};
+    alignas(32) float z1[ENVELOPE_LANES] = {};
+    alignas(32) float z2[ENVELOPE_LANES] = {};
+
+    // Follower state
+    alignas(32) float env[ENVELOPE_LANES] = {};
+    alignas(32) float peak[ENVELOPE_LANES] = {};
+    alignas(32) float hold[ENVELOPE_LANES] = {};
+
+    std::atomic<float> publishedEnvelope[ENVELOPE_BANDS];
+    std::atomic<float> publishedPeak[ENVELOPE_BANDS];
+};
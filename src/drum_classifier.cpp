@@ -0,0 +1,75 @@
+#include "drum_classifier.h"
+#include <cmath>
+#include <algorithm>
+
+namespace {
+    const float LEVEL_FLOOR = 1e-3f;     // ~-60 dBFS, quieter onsets are ignored
+    const float ADAPT_TIME = 1.0f;       // time constant of the threshold statistics (s)
+    const float LEVEL_MAX_RELEASE = 4.0f; // velocity reference release (s)
+    const float REFRACTORY[DRUM_PART_COUNT] = {0.10f, 0.10f, 0.05f};
+    const float THRESHOLD_DEVIATIONS = 2.5f;
+    const float MIN_RISE = 0.5f;         // log units, about +4 dB
+}
+
+DrumClassifier::DrumClassifier(float sampleRate)
+    : sampleRate(sampleRate), sensitivity(1.0f) {
+    for (int h = 0; h < HISTORY; ++h) {
+        for (int b = 0; b < ENVELOPE_BANDS; ++b) logEnv[h][b] = std::log(LEVEL_FLOOR);
+    }
+}
+
+void DrumClassifier::process(const float* envelope, int frames) {
+    float dt = frames / sampleRate;
+    float sens = std::max(0.1f, sensitivity.load(std::memory_order_relaxed));
+
+    // Rise of each band over the history window; the oldest entry is the next one to overwrite
+    float rise[ENVELOPE_BANDS];
+    for (int b = 0; b < ENVELOPE_BANDS; ++b) {
+        float now = std::log(std::max(envelope[b], LEVEL_FLOOR));
+        rise[b] = std::max(0.0f, now - logEnv[historyPos][b]);
+        logEnv[historyPos][b] = now;
+    }
+    historyPos = (historyPos + 1) % HISTORY;
+
+    // Band-limited onset functions and the level each part is judged by
+    float onset[DRUM_PART_COUNT] = {
+        rise[0],
+        (rise[1] + rise[2] + rise[3]) / 3.0f,
+        rise[4]
+    };
+    float level[DRUM_PART_COUNT] = {
+        envelope[0],
+        std::max(envelope[1], std::max(envelope[2], envelope[3])),
+        envelope[4]
+    };
+
+    // Spectral shape of the onset: which bands rose together
+    float maxRise = *std::max_element(rise, rise + ENVELOPE_BANDS);
+    float minMidRise = std::min(rise[1], std::min(rise[2], rise[3]));
+    bool shape[DRUM_PART_COUNT] = {
+        rise[0] >= maxRise * 0.8f && rise[0] > rise[4] * 2.0f,      // kick: bass led, little top end
+        minMidRise >= maxRise * 0.3f && rise[2] + rise[3] > rise[0], // snare: broadband body and crack
+        rise[4] >= maxRise * 0.8f && rise[4] > rise[0] * 2.0f       // hat: treble led, little bass
+    };
+
+    float adapt = std::min(1.0f, dt / ADAPT_TIME);
+    float levelDecay = std::exp(-dt / LEVEL_MAX_RELEASE);
+    for (int p = 0; p < DRUM_PART_COUNT; ++p) {
+        refractoryLeft[p] = std::max(0.0f, refractoryLeft[p] - dt);
+        levelMax[p] = std::max(level[p], levelMax[p] * levelDecay);
+
+        float threshold = std::max(MIN_RISE, onsetMean[p] + THRESHOLD_DEVIATIONS * onsetDev[p]) / sens;
+        if (shape[p] && onset[p] > threshold && level[p] > LEVEL_FLOOR && refractoryLeft[p] <= 0.0f) {
+            float loudness = levelMax[p] > 0.0f ? level[p] / levelMax[p] : 0.0f;
+            float strength = std::min(1.0f, onset[p] / (2.0f * threshold));
+            DrumEvent event;
+            event.part = (uint8_t)p;
+            event.velocity = std::max(0.0f, std::min(1.0f, 0.5f * loudness + 0.5f * strength));
+            events.push(event); // dropped if the renderer stalls
+            refractoryLeft[p] = REFRACTORY[p];
+        }
+
+        onsetMean[p] += (onset[p] - onsetMean[p]) * adapt;
+        onsetDev[p] += (std::fabs(onset[p] - onsetMean[p]) - onsetDev[p]) * adapt;
+    }
+}
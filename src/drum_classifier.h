@@ -0,0 +1,48 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include "band_envelope.h"
+#include "utils/ring_buffer.h"
+
+enum DrumPart : uint8_t { DRUM_KICK = 0, DRUM_SNARE, DRUM_HAT, DRUM_PART_COUNT };
+
+struct DrumEvent {
+    uint8_t part;
+    float velocity; // 0-1
+};
+
+// Lightweight percussive classifier fed by the band envelopes on the capture
+// thread. Each part has a band-limited onset function (log rise of its bands
+// over ~10 ms) with an adaptive threshold and a refractory period; onsets are
+// only accepted when the band balance has the right shape (kick: bass heavy,
+// snare: broadband, hat: treble heavy). Events go through a lock-free queue.
+class DrumClassifier {
+public:
+    explicit DrumClassifier(float sampleRate = 48000.0f);
+
+    // Capture thread: envelope levels after a block of `frames` samples
+    void process(const float* envelope, int frames);
+
+    // Render thread: returns false when no event is pending
+    bool popEvent(DrumEvent& event) { return events.pop(event); }
+
+    // Higher = more triggers (scales the adaptive threshold)
+    void setSensitivity(float s) { sensitivity.store(s, std::memory_order_relaxed); }
+
+private:
+    static const int HISTORY = 4; // blocks of envelope history for the onset rise
+
+    float sampleRate;
+    float logEnv[HISTORY][ENVELOPE_BANDS] = {};
+    int historyPos = 0;
+
+    // Adaptive threshold: running mean and mean deviation of each onset function
+    float onsetMean[DRUM_PART_COUNT] = {};
+    float onsetDev[DRUM_PART_COUNT] = {};
+    // Loudness reference for velocities (slowly decaying maximum)
+    float levelMax[DRUM_PART_COUNT] = {};
+    float refractoryLeft[DRUM_PART_COUNT] = {}; // seconds
+
+    std::atomic<float> sensitivity;
+    RingBuffer<DrumEvent, 64> events;
+};
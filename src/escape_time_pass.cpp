@@ -0,0 +1,238 @@
+#include "escape_time_pass.h"
+#include "shader_utils.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+    // Fullscreen triangle without vertex buffers
+    const char* FULLSCREEN_VERTEX_SHADER = R"(
+#version 330 core
+out vec2 vUv;
+void main() {
+    vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    vUv = p;
+    gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+    const char* ESCAPE_FRAGMENT_SHADER = R"(
+#version 330 core
+in vec2 vUv;
+out vec4 FragColor;
+uniform vec2 uCenter;
+uniform float uScale;     // half height of the view in the complex plane
+uniform float uAspect;
+uniform vec2 uJulia;
+uniform int uType;        // 0 Mandelbrot, 1 Julia
+uniform int uMaxIter;
+uniform vec3 uColors[3];
+uniform float uCycle;
+
+vec3 palette(float t) {
+    // Cyclic blend through the three stops
+    t = fract(t);
+    vec3 a = t < 1.0 / 3.0 ? uColors[0] : (t < 2.0 / 3.0 ? uColors[1] : uColors[2]);
+    vec3 b = t < 1.0 / 3.0 ? uColors[1] : (t < 2.0 / 3.0 ? uColors[2] : uColors[0]);
+    float f = fract(t * 3.0);
+    return mix(a, b, f * f * (3.0 - 2.0 * f));
+}
+
+void main() {
+    vec2 p = uCenter + (vUv * 2.0 - 1.0) * vec2(uScale * uAspect, uScale);
+    vec2 z = uType == 0 ? vec2(0.0) : p;
+    vec2 c = uType == 0 ? p : uJulia;
+
+    // Skip the main cardioid and period-2 bulb of the Mandelbrot set
+    if (uType == 0) {
+        float q = (p.x - 0.25) * (p.x - 0.25) + p.y * p.y;
+        if (q * (q + (p.x - 0.25)) < 0.25 * p.y * p.y || (p.x + 1.0) * (p.x + 1.0) + p.y * p.y < 0.0625) {
+            FragColor = vec4(0.0, 0.0, 0.0, 1.0);
+            return;
+        }
+    }
+
+    int i = 0;
+    float r2 = 0.0;
+    for (; i < 4096; ++i) {
+        if (i >= uMaxIter) break;
+        z = vec2(z.x * z.x - z.y * z.y, 2.0 * z.x * z.y) + c;
+        r2 = dot(z, z);
+        if (r2 > 256.0) break;
+    }
+    if (i >= uMaxIter) {
+        FragColor = vec4(0.0, 0.0, 0.0, 1.0);
+        return;
+    }
+    // Continuous escape count: no banding between iteration steps
+    float smoothIter = float(i) + 1.0 - log2(0.5 * log(r2));
+    FragColor = vec4(palette(smoothIter * 0.02 + uCycle), 1.0);
+}
+)";
+
+    const char* BLIT_FRAGMENT_SHADER = R"(
+#version 330 core
+in vec2 vUv;
+out vec4 FragColor;
+uniform sampler2D uSource;
+void main() {
+    FragColor = texture(uSource, vUv);
+}
+)";
+
+    // Resolution steps used by autoResolution
+    const float SCALE_STEPS[] = {1.0f, 0.75f, 0.5f, 0.35f, 0.25f};
+    const int SCALE_STEP_COUNT = sizeof(SCALE_STEPS) / sizeof(SCALE_STEPS[0]);
+
+    bool linked(GLuint program) {
+        GLint ok = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &ok);
+        return ok != 0;
+    }
+}
+
+bool EscapeTimePass::init() {
+    destroy();
+    GLuint fractal = createShaderProgram(FULLSCREEN_VERTEX_SHADER, ESCAPE_FRAGMENT_SHADER);
+    GLuint blit = createShaderProgram(FULLSCREEN_VERTEX_SHADER, BLIT_FRAGMENT_SHADER);
+    if (!linked(fractal) || !linked(blit)) {
+        std::cerr << "Mandelbrot/Julia no disponible (shader)" << std::endl;
+        glDeleteProgram(fractal);
+        glDeleteProgram(blit);
+        return false;
+    }
+    fractalProgram = fractal;
+    blitProgram = blit;
+    uCenter = glGetUniformLocation(fractalProgram, "uCenter");
+    uScale = glGetUniformLocation(fractalProgram, "uScale");
+    uAspect = glGetUniformLocation(fractalProgram, "uAspect");
+    uJulia = glGetUniformLocation(fractalProgram, "uJulia");
+    uType = glGetUniformLocation(fractalProgram, "uType");
+    uMaxIter = glGetUniformLocation(fractalProgram, "uMaxIter");
+    uColors = glGetUniformLocation(fractalProgram, "uColors");
+    uCycle = glGetUniformLocation(fractalProgram, "uCycle");
+    uSource = glGetUniformLocation(blitProgram, "uSource");
+
+    glGenVertexArrays(1, &emptyVao);
+    glGenQueries(QUERY_COUNT, queries);
+    for (bool& pending : queryPending) pending = false;
+    currentIterations = (float)std::min(maxIterations, 256);
+    currentScale = 1.0f;
+    return true;
+}
+
+void EscapeTimePass::destroy() {
+    if (fractalProgram) glDeleteProgram(fractalProgram);
+    if (blitProgram) glDeleteProgram(blitProgram);
+    if (emptyVao) glDeleteVertexArrays(1, &emptyVao);
+    if (fbo) glDeleteFramebuffers(1, &fbo);
+    if (colorTexture) glDeleteTextures(1, &colorTexture);
+    if (queries[0]) glDeleteQueries(QUERY_COUNT, queries);
+    fractalProgram = blitProgram = emptyVao = fbo = colorTexture = 0;
+    for (GLuint& q : queries) q = 0;
+    targetWidth = targetHeight = 0;
+}
+
+void EscapeTimePass::ensureTarget(int w, int h) {
+    if (fbo && w == targetWidth && h == targetHeight) return;
+    if (!fbo) {
+        glGenFramebuffers(1, &fbo);
+        glGenTextures(1, &colorTexture);
+    }
+    glBindTexture(GL_TEXTURE_2D, colorTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    targetWidth = w;
+    targetHeight = h;
+}
+
+void EscapeTimePass::adapt(float ms) {
+    lastGpuMs = ms;
+    if (!adaptive || ms <= 0.0f) return;
+    // Proportional step, limited so one slow frame doesn't halve the detail
+    float ratio = std::max(0.8f, std::min(1.25f, targetMs / ms));
+    currentIterations = std::max((float)minIterations, std::min((float)maxIterations, currentIterations * ratio));
+
+    if (!autoResolution) return;
+    int step = 0;
+    while (step < SCALE_STEP_COUNT - 1 && SCALE_STEPS[step] > currentScale + 0.001f) ++step;
+    if (ms > targetMs * 1.1f && currentIterations <= minIterations + 0.5f && step < SCALE_STEP_COUNT - 1) {
+        currentScale = SCALE_STEPS[step + 1];
+    } else if (ms < targetMs * 0.4f && currentIterations >= maxIterations - 0.5f && step > 0) {
+        currentScale = SCALE_STEPS[step - 1];
+    }
+}
+
+void EscapeTimePass::render(const Params& params, int width, int height) {
+    if (!ready() || width <= 0 || height <= 0) return;
+
+    // Result of the query issued QUERY_COUNT - 1 frames ago, if the GPU is done with it
+    int readIndex = (queryIndex + 1) % QUERY_COUNT;
+    if (queryPending[readIndex]) {
+        GLint available = 0;
+        glGetQueryObjectiv(queries[readIndex], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(queries[readIndex], GL_QUERY_RESULT, &ns);
+            queryPending[readIndex] = false;
+            adapt((float)(ns / 1.0e6));
+        }
+    }
+    if (!autoResolution) currentScale = std::max(0.1f, std::min(1.0f, resolutionScale));
+    if (!adaptive) currentIterations = (float)maxIterations;
+
+    bool reduced = currentScale < 0.999f;
+    int w = std::max(1, (int)(width * currentScale));
+    int h = std::max(1, (int)(height * currentScale));
+
+    bool timing = !queryPending[queryIndex];
+    if (timing) glBeginQuery(GL_TIME_ELAPSED, queries[queryIndex]);
+
+    GLint previousFbo = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFbo);
+    if (reduced) {
+        ensureTarget(w, h);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    }
+    glViewport(0, 0, w, h);
+    glDisable(GL_BLEND);
+
+    glUseProgram(fractalProgram);
+    glUniform2f(uCenter, params.centerX, params.centerY);
+    glUniform1f(uScale, 1.5f / std::max(1e-6f, params.zoom));
+    glUniform1f(uAspect, (float)width / (float)height);
+    glUniform2f(uJulia, params.juliaX, params.juliaY);
+    glUniform1i(uType, params.type);
+    glUniform1i(uMaxIter, (int)currentIterations);
+    glUniform3fv(uColors, 3, params.colors);
+    glUniform1f(uCycle, params.colorCycle);
+    glBindVertexArray(emptyVao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    if (reduced) {
+        // Upscale to the real framebuffer (a blit can't target the multisampled one)
+        glBindFramebuffer(GL_FRAMEBUFFER, previousFbo);
+        glViewport(0, 0, width, height);
+        glUseProgram(blitProgram);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, colorTexture);
+        glUniform1i(uSource, 0);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    glBindVertexArray(0);
+    glEnable(GL_BLEND);
+
+    if (timing) {
+        glEndQuery(GL_TIME_ELAPSED);
+        queryPending[queryIndex] = true;
+    }
+    queryIndex = (queryIndex + 1) % QUERY_COUNT;
+}
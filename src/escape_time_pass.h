@@ -0,0 +1,64 @@
+#pragma once
+#include <GL/glew.h>
+
+// Mandelbrot / Julia sets as a fullscreen fragment pass: escape-time
+// iteration per pixel with smooth (continuous) coloring. Two knobs keep it
+// within a GPU time budget, measured with GL_TIME_ELAPSED queries:
+// - the iteration limit adapts every frame between minIterations and maxIterations
+// - with autoResolution, the pass drops to a reduced-resolution target
+//   (upscaled with linear filtering) once the iterations are at the minimum
+class EscapeTimePass {
+public:
+    enum Type { MANDELBROT = 0, JULIA = 1 };
+
+    struct Params {
+        Type type = MANDELBROT;
+        float centerX = -0.5f, centerY = 0.0f;
+        float zoom = 1.0f;                  // 1 = about 3 units of height on screen
+        float juliaX = -0.8f, juliaY = 0.156f;
+        float colors[9] = {1.0f, 0.0f, 0.0f,  0.0f, 1.0f, 0.0f,  0.0f, 0.0f, 1.0f}; // palette stops
+        float colorCycle = 0.0f;            // palette offset
+    };
+
+    // Adaptive budget settings
+    float targetMs = 6.0f;                  // GPU time allowed for the pass
+    int minIterations = 32;
+    int maxIterations = 512;
+    bool adaptive = true;
+    bool autoResolution = true;
+    float resolutionScale = 1.0f;           // manual scale when autoResolution is off
+
+    // Needs a current GL context
+    bool init();
+    void destroy();
+    bool ready() const { return fractalProgram != 0; }
+
+    // Draws into the currently bound framebuffer (width x height)
+    void render(const Params& params, int width, int height);
+
+    int iterations() const { return (int)currentIterations; }
+    float scale() const { return currentScale; }
+    float gpuMs() const { return lastGpuMs; }
+
+private:
+    void ensureTarget(int w, int h);
+    void adapt(float ms);
+
+    GLuint fractalProgram = 0;
+    GLuint blitProgram = 0;
+    GLuint emptyVao = 0;                    // the fullscreen triangle comes from gl_VertexID
+    GLuint fbo = 0, colorTexture = 0;
+    int targetWidth = 0, targetHeight = 0;
+
+    static const int QUERY_COUNT = 3;       // results are read two frames later
+    GLuint queries[QUERY_COUNT] = {};
+    bool queryPending[QUERY_COUNT] = {};
+    int queryIndex = 0;
+
+    float currentIterations = 256.0f;
+    float currentScale = 1.0f;
+    float lastGpuMs = 0.0f;
+
+    GLint uCenter = -1, uScale = -1, uAspect = -1, uJulia = -1, uType = -1, uMaxIter = -1, uColors = -1, uCycle = -1;
+    GLint uSource = -1;
+};
@@ -0,0 +1,126 @@
+#include "flight_recorder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+namespace {
+    struct DumpInfo {
+        std::string path;
+        std::string reason;
+        std::vector<std::string> phaseNames;
+    };
+
+    bool writeDump(const DumpInfo& info, const std::vector<FlightRecorder::Frame>& frames) {
+        FILE* out = fopen(info.path.c_str(), "w");
+        if (!out) {
+            std::cerr << "No se pudo escribir el volcado: " << info.path << std::endl;
+            return false;
+        }
+        fprintf(out, "# %s\n", info.reason.c_str());
+        fprintf(out, "time_s,frame_ms");
+        for (const std::string& name : info.phaseNames) fprintf(out, ",\"%s\"", name.c_str());
+        fprintf(out, ",audio_fill,cache_misses\n");
+        for (const FlightRecorder::Frame& f : frames) {
+            fprintf(out, "%.4f,%.3f", f.time, f.frameMs);
+            for (size_t p = 0; p < info.phaseNames.size(); ++p) fprintf(out, ",%.3f", f.phaseMs[p]);
+            fprintf(out, ",%.3f,%u\n", f.audioFill, f.cacheMisses);
+        }
+        fclose(out);
+        return true;
+    }
+}
+
+FlightRecorder::FlightRecorder() : ring(CAPACITY) {}
+
+FlightRecorder::~FlightRecorder() {
+    if (dumpJob.valid()) dumpJob.wait();
+}
+
+int FlightRecorder::phaseIndex(const char* name) {
+    for (size_t i = 0; i < phaseNames.size(); ++i) {
+        if (phaseNames[i] == name || strcmp(phaseNames[i], name) == 0) return (int)i;
+    }
+    if ((int)phaseNames.size() == MAX_PHASES) return -1;
+    phaseNames.push_back(name);
+    return (int)phaseNames.size() - 1;
+}
+
+void FlightRecorder::setIdlePhase(const char* name) {
+    int p = phaseIndex(name);
+    if (p >= 0) idlePhase[p] = true;
+}
+
+void FlightRecorder::record(double time, const ProfilePhases& phases, float audioFill, uint32_t cacheMisses) {
+    Frame& f = ring[written % CAPACITY];
+    f.time = time;
+    f.frameMs = 0.0f;
+    std::fill(f.phaseMs, f.phaseMs + MAX_PHASES, 0.0f);
+    float busyMs = 0.0f;
+    // Phases that repeat in a frame (e.g. two UI blocks) add up
+    for (int i = 0; i < phases.size(); ++i) {
+        float ms = (float)profiler::ticksToMs(phases.ticks(i));
+        int p = phaseIndex(phases.name(i));
+        if (p >= 0) f.phaseMs[p] += ms;
+        if (p < 0 || !idlePhase[p]) busyMs += ms;
+        f.frameMs += ms;
+    }
+    f.audioFill = audioFill;
+    f.cacheMisses = cacheMisses;
+    ++written;
+    worstMs = std::max(worstMs, busyMs);
+
+    if (!enabled) return;
+    if (!triggered && busyMs > budgetMs && time - lastAutoDump >= cooldownSeconds) {
+        triggered = true;
+        triggerTime = time;
+        triggerMs = busyMs;
+    }
+    if (triggered && time - triggerTime >= postSeconds) {
+        char reason[160];
+        snprintf(reason, sizeof(reason), "frame de %.1f ms en t=%.3f s (presupuesto %.1f ms)",
+                 triggerMs, triggerTime, budgetMs);
+        // A dump still being written keeps the trigger armed for the next frame
+        if (dump(reason)) {
+            triggered = false;
+            lastAutoDump = time;
+        }
+    }
+}
+
+bool FlightRecorder::dump(const char* reason) {
+    if (written == 0) return false;
+    if (dumpJob.valid()) {
+        if (dumpJob.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+        dumpJob.get();
+    }
+
+    // Copy the window on this thread (plain memory), format and write it on another
+    const Frame& last = ring[(written - 1) % CAPACITY];
+    size_t available = (size_t)std::min<uint64_t>(written, (uint64_t)CAPACITY);
+    size_t count = 0;
+    while (count < available && last.time - ring[(written - 1 - count) % CAPACITY].time <= windowSeconds + postSeconds) {
+        ++count;
+    }
+    std::vector<Frame> frames(count);
+    for (size_t i = 0; i < count; ++i) frames[i] = ring[(written - count + i) % CAPACITY];
+
+    DumpInfo info;
+    // Milliseconds and the dump number keep two dumps in the same second apart
+    auto now = std::chrono::system_clock::now();
+    std::time_t t = std::chrono::system_clock::to_time_t(now);
+    int ms = (int)(std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000);
+    char stamp[32], path[80];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", std::localtime(&t));
+    snprintf(path, sizeof(path), "hitch_%s_%03d_%zu.csv", stamp, ms, dumps + 1);
+    info.path = path;
+    info.reason = reason;
+    for (const char* name : phaseNames) info.phaseNames.push_back(name);
+
+    lastPath = info.path;
+    ++dumps;
+    dumpJob = std::async(std::launch::async, [info, frames = std::move(frames)] { return writeDump(info, frames); });
+    return true;
+}
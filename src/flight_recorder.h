@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <future>
+#include <string>
+#include <vector>
+#include "profiler.h"
+
+// Always-on record of the last frames (phase timings, audio buffer fill,
+// geometry cache misses) in a fixed ring. When a frame goes over budgetMs
+// the recorder waits postSeconds to capture the aftermath, then writes the
+// last windowSeconds to hitch_<date>.csv from a background thread. Recording
+// a frame is a few stores into preallocated memory. Phases marked as idle
+// (deliberate sleeps) are recorded but don't count toward the budget.
+class FlightRecorder {
+public:
+    static const int MAX_PHASES = ProfilePhases::MAX_PHASES;
+    static const size_t CAPACITY = 1 << 14;   // ~16 s at 1000 FPS
+
+    struct Frame {
+        double time;                          // seconds (glfwGetTime)
+        float frameMs;
+        float phaseMs[MAX_PHASES];            // by phaseName() index
+        float audioFill;                      // 0-1
+        uint32_t cacheMisses;                 // geometry cache misses this frame
+    };
+
+    bool enabled = true;
+    float budgetMs = 100.0f;
+    float windowSeconds = 10.0f;
+    float postSeconds = 1.0f;
+    float cooldownSeconds = 30.0f;            // between automatic dumps
+
+    FlightRecorder();
+    ~FlightRecorder();
+
+    // Once per frame, after phases.end()
+    void record(double time, const ProfilePhases& phases, float audioFill, uint32_t cacheMisses);
+    // Writes the current window now; false while another dump is being written
+    bool dump(const char* reason);
+    // Time spent in this phase is left out of the budget check
+    void setIdlePhase(const char* name);
+
+    int phaseCount() const { return (int)phaseNames.size(); }
+    const char* phaseName(int i) const { return phaseNames[i]; }
+    size_t dumpCount() const { return dumps; }
+    const std::string& lastDumpPath() const { return lastPath; }
+    float worstFrameMs() const { return worstMs; }
+
+private:
+    int phaseIndex(const char* name);
+
+    std::vector<Frame> ring;
+    uint64_t written = 0;
+    std::vector<const char*> phaseNames;
+    bool idlePhase[MAX_PHASES] = {};
+    bool triggered = false;
+    double lastAutoDump = -1.0e9;
+    double triggerTime = 0.0;
+    float triggerMs = 0.0f;
+    float worstMs = 0.0f;
+    size_t dumps = 0;
+    std::string lastPath;
+    std::future<bool> dumpJob;
+};
@@ -0,0 +1,150 @@
+#include "geometry_cache.h"
+#include <cmath>
+#include <algorithm>
+
+bool GeometryKey::operator==(const GeometryKey& o) const {
+    if (shapeType != o.shapeType || nSegments != o.nSegments || size != o.size ||
+        fractalDepth != o.fractalDepth || fractalMode != o.fractalMode) {
+        return false;
+    }
+    for (int i = 0; i < 9; ++i) {
+        if (colors[i] != o.colors[i]) return false;
+    }
+    return true;
+}
+
+size_t GeometryKeyHash::operator()(const GeometryKey& k) const {
+    // FNV-1a over the fields
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](uint32_t v) {
+        for (int b = 0; b < 4; ++b) {
+            h ^= (v >> (b * 8)) & 0xFF;
+            h *= 1099511628211ull;
+        }
+    };
+    mix((uint32_t)k.shapeType);
+    mix((uint32_t)k.nSegments);
+    mix((uint32_t)k.size);
+    mix((uint32_t)k.fractalDepth);
+    mix(k.fractalMode ? 1u : 0u);
+    for (int i = 0; i < 9; ++i) mix(k.colors[i]);
+    return (size_t)h;
+}
+
+GeometryKey makeGeometryKey(int shapeType, float size, const float colors[9], int nSegments,
+                            bool fractalMode, float fractalDepth) {
+    GeometryKey key;
+    key.shapeType = shapeType;
+    key.nSegments = nSegments;
+    key.size = (int32_t)std::lround(size * 1000.0f);
+    key.fractalMode = fractalMode;
+    if (fractalMode) {
+        key.fractalDepth = (int32_t)std::lround(fractalDepth * 100.0f);
+        for (int i = 0; i < 9; ++i) {
+            key.colors[i] = (uint8_t)std::lround(std::max(0.0f, std::min(1.0f, colors[i])) * 255.0f);
+        }
+    }
+    return key;
+}
+
+GeometryCache::GeometryCache(size_t budgetBytes, size_t maxEntries)
+    : budget(budgetBytes), entryLimit(std::max<size_t>(1, maxEntries)) {}
+
+bool GeometryCache::valid(GeometryHandle h) const {
+    return h.index < slots.size() && slots[h.index].used && slots[h.index].generation == h.generation;
+}
+
+void GeometryCache::unlink(uint32_t i) {
+    Slot& s = slots[i];
+    if (s.prev != NONE) slots[s.prev].next = s.next; else head = s.next;
+    if (s.next != NONE) slots[s.next].prev = s.prev; else tail = s.prev;
+    s.prev = s.next = NONE;
+}
+
+void GeometryCache::pushFront(uint32_t i) {
+    Slot& s = slots[i];
+    s.prev = NONE;
+    s.next = head;
+    if (head != NONE) slots[head].prev = i;
+    head = i;
+    if (tail == NONE) tail = i;
+}
+
+GeometryHandle GeometryCache::find(const GeometryKey& key) {
+    auto it = lookup.find(key);
+    if (it == lookup.end()) {
+        ++missCount;
+        return GeometryHandle();
+    }
+    ++hitCount;
+    uint32_t i = it->second;
+    if (head != i) {
+        unlink(i);
+        pushFront(i);
+    }
+    return GeometryHandle{i, slots[i].generation};
+}
+
+GeometryHandle GeometryCache::insert(const GeometryKey& key, const CachedVBO& entry) {
+    // Replacing an existing key releases the old geometry
+    auto existing = lookup.find(key);
+    if (existing != lookup.end()) release(existing->second);
+
+    uint32_t i;
+    if (!freeSlots.empty()) {
+        i = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        i = (uint32_t)slots.size();
+        slots.emplace_back();
+    }
+    Slot& s = slots[i];
+    s.entry = entry;
+    s.key = key;
+    s.used = true;
+    pushFront(i);
+    lookup[key] = i;
+    ++count;
+    usedBytes += entry.bytes;
+
+    trim(i);
+    return GeometryHandle{i, s.generation};
+}
+
+CachedVBO* GeometryCache::get(GeometryHandle h) {
+    return valid(h) ? &slots[h.index].entry : nullptr;
+}
+
+void GeometryCache::remove(GeometryHandle h) {
+    if (valid(h)) release(h.index);
+}
+
+void GeometryCache::release(uint32_t i) {
+    Slot& s = slots[i];
+    if (s.entry.VAO) glDeleteVertexArrays(1, &s.entry.VAO);
+    if (s.entry.VBO) glDeleteBuffers(1, &s.entry.VBO);
+    unlink(i);
+    lookup.erase(s.key);
+    usedBytes -= s.entry.bytes;
+    --count;
+    s.entry = CachedVBO();
+    s.used = false;
+    ++s.generation; // invalidates outstanding handles
+    freeSlots.push_back(i);
+}
+
+void GeometryCache::trim(uint32_t keep) {
+    while ((usedBytes > budget || count > entryLimit) && tail != NONE && tail != keep) {
+        release(tail);
+    }
+}
+
+void GeometryCache::clear() {
+    while (head != NONE) release(head);
+}
+
+void GeometryCache::setBudget(size_t budgetBytes, size_t maxEntries) {
+    budget = budgetBytes;
+    entryLimit = std::max<size_t>(1, maxEntries);
+    trim(head);
+}
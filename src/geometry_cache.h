@@ -0,0 +1,101 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <unordered_map>
+
+// Geometry built for one set of shape parameters
+struct CachedVBO {
+    GLuint VAO = 0;
+    GLuint VBO = 0;
+    int shapeType = -1;
+    float size = 0.0f;
+    float colors[9] = {0}; // 3 colors * 3 components (fractals only)
+    int nSegments = 0;
+    bool fractalMode = false;
+    float fractalDepth = 0.0f;
+    GLsizei vertexCount = 0;
+    GLenum primitive = GL_TRIANGLES;
+    size_t bytes = 0;      // GPU memory counted against the cache budget
+};
+
+// Shape parameters quantized so nearly equal floats share one entry. Colors
+// are only part of the key for fractals; plain shapes take them per instance.
+struct GeometryKey {
+    int32_t shapeType = -1;
+    int32_t nSegments = 0;
+    int32_t size = 0;          // 1/1000 units
+    int32_t fractalDepth = 0;  // 1/100 levels
+    bool fractalMode = false;
+    uint8_t colors[9] = {};
+
+    bool operator==(const GeometryKey& other) const;
+};
+
+struct GeometryKeyHash {
+    size_t operator()(const GeometryKey& key) const;
+};
+
+GeometryKey makeGeometryKey(int shapeType, float size, const float colors[9], int nSegments,
+                            bool fractalMode, float fractalDepth);
+
+// Refers to a cache slot; once the entry is evicted or removed the slot's
+// generation changes and the handle resolves to nullptr instead of dangling
+struct GeometryHandle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+};
+
+// Hash map lookup, LRU eviction under a memory and entry budget, and stable
+// generational handles. Owns the GL objects of its entries.
+class GeometryCache {
+public:
+    explicit GeometryCache(size_t budgetBytes = 32u << 20, size_t maxEntries = 64);
+
+    // Handle of the entry for `key` (marked most recently used), or an invalid handle
+    GeometryHandle find(const GeometryKey& key);
+    // Takes ownership of entry's VAO/VBO, evicting least recently used entries
+    // to stay within budget
+    GeometryHandle insert(const GeometryKey& key, const CachedVBO& entry);
+    // nullptr for stale handles. The pointer is only valid until the next insert().
+    CachedVBO* get(GeometryHandle handle);
+    void remove(GeometryHandle handle);
+    void clear();
+
+    void setBudget(size_t budgetBytes, size_t maxEntries);
+    size_t size() const { return count; }
+    size_t bytes() const { return usedBytes; }
+    // Lookups since construction, for the frame statistics
+    uint64_t hits() const { return hitCount; }
+    uint64_t misses() const { return missCount; }
+
+private:
+    static const uint32_t NONE = UINT32_MAX;
+    struct Slot {
+        CachedVBO entry;
+        GeometryKey key;
+        uint32_t generation = 1;
+        bool used = false;
+        uint32_t prev = NONE; // towards most recently used
+        uint32_t next = NONE; // towards least recently used
+    };
+
+    bool valid(GeometryHandle handle) const;
+    void unlink(uint32_t index);
+    void pushFront(uint32_t index);
+    void release(uint32_t index);
+    void trim(uint32_t keep);
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    std::unordered_map<GeometryKey, uint32_t, GeometryKeyHash> lookup;
+    uint32_t head = NONE; // most recently used
+    uint32_t tail = NONE; // least recently used
+    size_t count = 0;
+    size_t usedBytes = 0;
+    uint64_t hitCount = 0;
+    uint64_t missCount = 0;
+    size_t budget;
+    size_t entryLimit;
+};
@@ -0,0 +1,70 @@
+#include "goertzel_bands.h"
+#include <cmath>
+#include <algorithm>
+
+namespace {
+    // Same band edges as the FFT analysis
+    const float BAND_EDGES[GOERTZEL_BANDS + 1] = {20.0f, 150.0f, 400.0f, 2000.0f, 6000.0f, 20000.0f};
+}
+
+GoertzelBandBank::GoertzelBandBank(float sampleRate, int blockSize)
+    : blockSize(std::max(16, blockSize)), publishedOverall(0.0f), publishedPeak(0.0f) {
+    float nyquist = 0.5f * sampleRate;
+    for (int b = 0; b < GOERTZEL_BANDS; ++b) {
+        publishedBands[b].store(0.0f, std::memory_order_relaxed);
+        float lo = BAND_EDGES[b];
+        float hi = std::min(BAND_EDGES[b + 1], 0.95f * nyquist);
+        // Bins log-spaced through the band, at the centre of each sub-band
+        for (int k = 0; k < GOERTZEL_BINS_PER_BAND; ++k) {
+            float hz = lo * std::pow(hi / lo, (k + 0.5f) / GOERTZEL_BINS_PER_BAND);
+            coef[b * GOERTZEL_BINS_PER_BAND + k] = 2.0f * std::cos(2.0f * 3.14159265f * hz / sampleRate);
+        }
+        bandShare[b] = std::max(0.0f, hi - lo) / nyquist;
+    }
+    // Padding lanes keep a zero coefficient and are never read
+}
+
+void GoertzelBandBank::process(const float* samples, int count) {
+    for (int s = 0; s < count; ++s) {
+        const float x = samples[s];
+        // Fixed-width loop over the padded lanes, one vector pass per sample
+        for (int l = 0; l < GOERTZEL_LANES; ++l) {
+            float s0 = x + coef[l] * s1[l] - s2[l];
+            s2[l] = s1[l];
+            s1[l] = s0;
+        }
+        if (++position >= blockSize) publish();
+    }
+}
+
+void GoertzelBandBank::publish() {
+    float overall = 0.0f;
+    float peak = 0.0f;
+    for (int b = 0; b < GOERTZEL_BANDS; ++b) {
+        float sum = 0.0f;
+        for (int k = 0; k < GOERTZEL_BINS_PER_BAND; ++k) {
+            int l = b * GOERTZEL_BINS_PER_BAND + k;
+            float power = s1[l] * s1[l] + s2[l] * s2[l] - coef[l] * s1[l] * s2[l];
+            float magnitude = std::sqrt(std::max(0.0f, power));
+            sum += magnitude;
+            peak = std::max(peak, magnitude);
+        }
+        float level = sum / GOERTZEL_BINS_PER_BAND;
+        overall += level * bandShare[b];
+        publishedBands[b].store(level, std::memory_order_relaxed);
+    }
+    publishedOverall.store(overall, std::memory_order_relaxed);
+    publishedPeak.store(peak, std::memory_order_relaxed);
+
+    std::fill(s1, s1 + GOERTZEL_LANES, 0.0f);
+    std::fill(s2, s2 + GOERTZEL_LANES, 0.0f);
+    position = 0;
+}
+
+void GoertzelBandBank::read(float* bands, float& overall, float& peak) const {
+    for (int b = 0; b < GOERTZEL_BANDS; ++b) {
+        bands[b] = publishedBands[b].load(std::memory_order_relaxed);
+    }
+    overall = publishedOverall.load(std::memory_order_relaxed);
+    peak = publishedPeak.load(std::memory_order_relaxed);
+}
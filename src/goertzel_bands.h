@@ -0,0 +1,38 @@
+#pragma once
+#include <atomic>
+
+// Goertzel bins per band and the padded lane count (one AVX register pair)
+const int GOERTZEL_BANDS = 5;
+const int GOERTZEL_BINS_PER_BAND = 3;
+const int GOERTZEL_LANES = 16;
+
+// Ultra-low-cost band tracker for performance mode: a few Goertzel bins per
+// band, updated per sample on the capture thread. Every `blockSize` samples
+// it publishes the mean bin magnitude of each band, on the same scale as the
+// FFT bands of an FFT of that size, so presets behave the same.
+class GoertzelBandBank {
+public:
+    explicit GoertzelBandBank(float sampleRate = 48000.0f, int blockSize = 1024);
+
+    // Capture thread
+    void process(const float* samples, int count);
+
+    // Any thread: band levels (GOERTZEL_BANDS values), overall level and peak
+    // bin, as in AudioAnalysis
+    void read(float* bands, float& overall, float& peak) const;
+
+private:
+    void publish();
+
+    int blockSize;
+    int position = 0;
+    float bandShare[GOERTZEL_BANDS] = {}; // fraction of the FFT bins in each band, for `overall`
+
+    alignas(32) float coef[GOERTZEL_LANES] = {};
+    alignas(32) float s1[GOERTZEL_LANES] = {};
+    alignas(32) float s2[GOERTZEL_LANES] = {};
+
+    std::atomic<float> publishedBands[GOERTZEL_BANDS];
+    std::atomic<float> publishedOverall;
+    std::atomic<float> publishedPeak;
+};
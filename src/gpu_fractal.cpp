@@ -0,0 +1,251 @@
+#include "gpu_fractal.h"
+#include "shader_utils.h"
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+
+namespace {
+    // Mirrors createFractal: per shape, where the children of a node of size
+    // s sit and how big they are. The root has size `size / 2` and angle = time.
+    const char* IFS_VERTEX_SHADER = R"(
+#version 330 core
+layout(location = 0) in vec3 aNode;    // node vertex (xy, unit size) + color rotation (z)
+layout(location = 2) in vec2 aOffset;  // per fractal copy
+layout(location = 3) in float aAngle;
+layout(location = 4) in vec2 aScale;
+out vec3 vColor;
+uniform float uAspect;
+uniform float uTime;
+uniform float uSize;
+uniform int uShape;
+uniform int uLevels;
+uniform int uNodes;
+uniform vec3 uBaseColor;
+const float PI = 3.14159265;
+
+vec2 rotate2(vec2 p, float a) {
+    float c = cos(a), s = sin(a);
+    return vec2(c * p.x - s * p.y, s * p.x + c * p.y);
+}
+
+void main() {
+    int node = gl_InstanceID % uNodes;
+    int branch = (uShape == 0 || uShape == 3) ? 3 : 4;
+
+    // Level d holds branch^d nodes, root first
+    int depth = 0;
+    int first = 0;
+    int count = 1;
+    while (node >= first + count) {
+        first += count;
+        count *= branch;
+        depth++;
+    }
+    int path = node - first;
+
+    // Compose the child maps from the root down, most significant digit first
+    vec2 pos = vec2(0.0);
+    float s = uSize * 0.5;
+    float angle = uTime;
+    int level = uLevels;
+    int digitWeight = count / branch;
+    for (int d = 0; d < depth; ++d) {
+        int child = (path / digitWeight) % branch;
+        digitWeight /= branch;
+        float scale = s * 0.5;
+        if (uShape == 0) {
+            float r = scale + sin(uTime * 2.0 + float(level) * 0.5) * 0.1;
+            float a = angle + float(child) * 2.0944;
+            pos += r * vec2(cos(a), sin(a));
+            s = scale;
+            angle += uTime * (child == 0 ? 0.5 : (child == 1 ? 0.7 : 0.3));
+        } else if (uShape == 1) {
+            vec2 corner = child == 0 ? vec2(-1.0, -1.0) : child == 1 ? vec2(1.0, -1.0) : child == 2 ? vec2(1.0, 1.0) : vec2(-1.0, 1.0);
+            pos += scale * corner;
+            s = scale;
+            angle += uTime * 0.2 * float(child + 1);
+        } else if (uShape == 2) {
+            float a = float(child) * PI / 2.0 + uTime * 0.3;
+            pos += scale * 0.7 * vec2(cos(a), sin(a));
+            s = scale * 0.5;
+            angle = a;
+        } else if (uShape == 3) {
+            float a = angle + float(child) * PI / 3.0 + uTime * 0.2;
+            pos += scale * 0.6 * vec2(cos(a), sin(a));
+            s = scale * 0.4;
+            angle = a;
+        } else {
+            float a = angle + float(child) * PI / 2.0 + uTime * 0.3;
+            pos += scale * 0.8 * vec2(cos(a), sin(a));
+            s = scale * 0.5;
+            angle = a;
+        }
+        level--;
+    }
+
+    // The node's own shape
+    float scale = s * 0.5;
+    vec2 local;
+    if (uShape == 0) local = rotate2(aNode.xy, angle) * (scale + sin(uTime * 2.0 + float(level) * 0.5) * 0.1);
+    else if (uShape == 3) local = rotate2(aNode.xy, angle) * scale;
+    else if (uShape == 4) local = rotate2(aNode.xy, angle + uTime * 0.1) * scale * 1.5;
+    else local = aNode.xy * scale;
+
+    // Colors animated per level, rotated per vertex
+    float r = clamp(uBaseColor.r + sin(uTime + float(level)) * 0.3, 0.0, 1.0);
+    float g = clamp(uBaseColor.g + cos(uTime + float(level) * 0.7) * 0.3, 0.0, 1.0);
+    float b = clamp(uBaseColor.b + sin(uTime * 1.5 + float(level) * 0.3) * 0.3, 0.0, 1.0);
+    int rotation = int(aNode.z + 0.5);
+    vColor = rotation == 0 ? vec3(r, g, b) : (rotation == 1 ? vec3(g, b, r) : vec3(b, r, g));
+
+    // Same instance transform as the main shader
+    float sa = sin(aAngle);
+    float ca = cos(aAngle);
+    mat2 rot = mat2(ca, -sa, sa, ca);
+    vec2 p = rot * ((pos + local) * aScale) + aOffset;
+    p.x /= uAspect;
+    gl_Position = vec4(p, 0.0, 1.0);
+}
+)";
+
+    const char* IFS_FRAGMENT_SHADER = R"(
+#version 330 core
+in vec3 vColor;
+out vec4 FragColor;
+void main() {
+    FragColor = vec4(vColor, 1.0);
+}
+)";
+
+    void push(std::vector<float>& v, float x, float y, int rotation) {
+        v.push_back(x);
+        v.push_back(y);
+        v.push_back((float)rotation);
+    }
+}
+
+int GpuFractal::branching(int shapeType) {
+    return (shapeType == SHAPE_TRIANGLE || shapeType == SHAPE_LINE) ? 3 : 4;
+}
+
+int GpuFractal::nodeCount(int shapeType, int levels) {
+    int k = branching(shapeType);
+    int total = 0, count = 1;
+    for (int d = 0; d < levels; ++d) {
+        total += count;
+        count *= k;
+    }
+    return std::max(1, total);
+}
+
+GLenum GpuFractal::primitive(int shapeType) {
+    return (shapeType == SHAPE_LINE || shapeType == SHAPE_LONG_LINES) ? GL_LINES : GL_TRIANGLES;
+}
+
+bool GpuFractal::init() {
+    destroy();
+    GLuint p = createShaderProgram(IFS_VERTEX_SHADER, IFS_FRAGMENT_SHADER);
+    GLint linked = 0;
+    glGetProgramiv(p, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        std::cerr << "Fractal GPU no disponible, se usa la generación en CPU" << std::endl;
+        glDeleteProgram(p);
+        return false;
+    }
+    program = p;
+    uAspect = glGetUniformLocation(program, "uAspect");
+    uTime = glGetUniformLocation(program, "uTime");
+    uSize = glGetUniformLocation(program, "uSize");
+    uShape = glGetUniformLocation(program, "uShape");
+    uLevels = glGetUniformLocation(program, "uLevels");
+    uNodes = glGetUniformLocation(program, "uNodes");
+    uBaseColor = glGetUniformLocation(program, "uBaseColor");
+
+    // One node of each shape at unit size, laid out like createFractal draws it
+    std::vector<float> v;
+    auto begin = [&](int shape) { firstVertex[shape] = (GLint)(v.size() / 3); };
+    auto end = [&](int shape) { vertexCount[shape] = (GLsizei)(v.size() / 3) - firstVertex[shape]; };
+
+    begin(SHAPE_TRIANGLE);
+    for (int i = 0; i < 3; ++i) push(v, cosf(i * 2.0944f), sinf(i * 2.0944f), i);
+    end(SHAPE_TRIANGLE);
+
+    begin(SHAPE_SQUARE);
+    push(v, -1.0f, -1.0f, 0); push(v, 1.0f, -1.0f, 1); push(v, 1.0f, 1.0f, 2);
+    push(v, -1.0f, -1.0f, 0); push(v, 1.0f, 1.0f, 2); push(v, -1.0f, 1.0f, 0);
+    end(SHAPE_SQUARE);
+
+    begin(SHAPE_CIRCLE);
+    const int CIRCLE_SEGMENTS = 8;
+    for (int i = 0; i < CIRCLE_SEGMENTS; ++i) {
+        float t1 = 2.0f * (float)M_PI * i / CIRCLE_SEGMENTS;
+        float t2 = 2.0f * (float)M_PI * (i + 1) / CIRCLE_SEGMENTS;
+        push(v, 0.0f, 0.0f, 0);
+        push(v, cosf(t1), sinf(t1), 1);
+        push(v, cosf(t2), sinf(t2), 2);
+    }
+    end(SHAPE_CIRCLE);
+
+    begin(SHAPE_LINE);
+    push(v, -1.0f, 0.0f, 0); push(v, 1.0f, 0.0f, 1);
+    end(SHAPE_LINE);
+
+    begin(SHAPE_LONG_LINES);
+    for (int i = 0; i < 6; ++i) {
+        float a = i * (float)M_PI / 3.0f;
+        push(v, -cosf(a), -sinf(a), 0);
+        push(v, cosf(a), sinf(a), 1);
+    }
+    end(SHAPE_LONG_LINES);
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, v.size() * sizeof(float), v.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    for (int a = 2; a <= 7; ++a) glEnableVertexAttribArray(a);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    lastDivisor = -1;
+    return true;
+}
+
+void GpuFractal::destroy() {
+    if (program) glDeleteProgram(program);
+    if (vao) glDeleteVertexArrays(1, &vao);
+    if (vbo) glDeleteBuffers(1, &vbo);
+    program = vao = vbo = 0;
+}
+
+void GpuFractal::bind(int shapeType, int levels, float size, const float baseColor[3], float time, float aspect) {
+    boundShape = std::max(0, std::min(SHAPE_COUNT - 1, shapeType));
+    levels = std::max(1, std::min((int)MAX_LEVELS, levels));
+    boundNodes = nodeCount(boundShape, levels);
+
+    glUseProgram(program);
+    glUniform1f(uAspect, aspect);
+    glUniform1f(uTime, time);
+    glUniform1f(uSize, size);
+    glUniform1i(uShape, boundShape);
+    glUniform1i(uLevels, levels);
+    glUniform1i(uNodes, boundNodes);
+    glUniform3f(uBaseColor, baseColor[0], baseColor[1], baseColor[2]);
+
+    glBindVertexArray(vao);
+    // Each fractal copy's attributes cover all of its nodes
+    if (lastDivisor != boundNodes) {
+        for (int a = 2; a <= 7; ++a) glVertexAttribDivisor(a, boundNodes);
+        lastDivisor = boundNodes;
+    }
+}
+
+void GpuFractal::draw(GLsizei instanceCount) {
+    if (instanceCount > 0) {
+        glDrawArraysInstanced(primitive(boundShape), firstVertex[boundShape], vertexCount[boundShape],
+                              instanceCount * boundNodes);
+    }
+    glBindVertexArray(0);
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <GL/glew.h>
+#include "shape_types.h"
+
+// Iterated-function-system fractals expanded on the GPU. Each base shape
+// defines the affine map from a node to each of its children (offset,
+// scale and rotation, animated by time), and every node of the tree is one
+// GPU instance: the vertex shader decodes the level and child path from
+// gl_InstanceID and composes the maps from the root. The CPU only uploads
+// uniforms, so its cost does not depend on depth.
+//
+// Several copies of the fractal are drawn in the same call: the caller's
+// per-instance attributes (locations 2-7) advance once every nodeCount()
+// GPU instances.
+class GpuFractal {
+public:
+    static const int MAX_LEVELS = 8;
+
+    // Needs a current GL context
+    bool init();
+    void destroy();
+    bool ready() const { return program != 0; }
+
+    static int branching(int shapeType);
+    // Nodes in a tree of `levels` levels, root included
+    static int nodeCount(int shapeType, int levels);
+    static GLenum primitive(int shapeType);
+
+    // Binds program and VAO and sets the uniforms. The caller then points
+    // attributes 2-7 at its instance data and calls draw().
+    void bind(int shapeType, int levels, float size, const float baseColor[3], float time, float aspect);
+    void draw(GLsizei instanceCount);
+
+private:
+    GLuint program = 0;
+    GLuint vao = 0;
+    GLuint vbo = 0;
+    GLint firstVertex[SHAPE_COUNT] = {};
+    GLsizei vertexCount[SHAPE_COUNT] = {};
+    int boundShape = 0;
+    int boundNodes = 1;
+    int lastDivisor = -1;
+    GLint uAspect = -1, uTime = -1, uSize = -1, uShape = -1, uLevels = -1, uNodes = -1, uBaseColor = -1;
+};
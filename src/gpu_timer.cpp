@@ -0,0 +1,134 @@
+#include "gpu_timer.h"
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+
+namespace {
+    const float AVERAGE_WEIGHT = 0.05f;   // ~20 frames
+    const float PEAK_DECAY = 0.98f;       // per resolved frame
+}
+
+void GpuTimer::init() {
+    destroy();
+    // Timestamps are core in 3.3 (ARB_timer_query)
+    if (GLEW_VERSION_3_3 || GLEW_ARB_timer_query) {
+        for (int f = 0; f < FRAMES_IN_FLIGHT; ++f) glGenQueries(MAX_PASSES * 2, queries[f]);
+    }
+}
+
+void GpuTimer::destroy() {
+    if (gpuAvailable()) {
+        for (int f = 0; f < FRAMES_IN_FLIGHT; ++f) glDeleteQueries(MAX_PASSES * 2, queries[f]);
+    }
+    for (int f = 0; f < FRAMES_IN_FLIGHT; ++f) {
+        std::fill(queries[f], queries[f] + MAX_PASSES * 2, 0u);
+        frames[f] = FrameQueries();
+    }
+    openPass = -1;
+}
+
+int GpuTimer::statIndex(const char* name) {
+    for (size_t i = 0; i < statNames.size(); ++i) {
+        if (statNames[i] == name || strcmp(statNames[i], name) == 0) return (int)i;
+    }
+    statNames.push_back(name);
+    PassStats s;
+    s.name = name;
+    stats.push_back(s);
+    return (int)stats.size() - 1;
+}
+
+void GpuTimer::beginFrame() {
+    if (openPass >= 0) end();
+    current = (current + 1) % FRAMES_IN_FLIGHT;
+    FrameQueries& frame = frames[current];
+    if (frame.recorded) resolve(current);
+    frame.passCount = 0;
+    frame.recorded = false;
+    frame.number = ++frameNumber;
+}
+
+void GpuTimer::begin(const char* name) {
+    if (openPass >= 0) end();
+    FrameQueries& frame = frames[current];
+    if (frame.passCount >= MAX_PASSES) return;
+    openPass = frame.passCount++;
+    frame.passIndex[openPass] = statIndex(name);
+    frame.recorded = true;
+    if (gpuAvailable()) glQueryCounter(queries[current][openPass * 2], GL_TIMESTAMP);
+    cpuStart = std::chrono::steady_clock::now();
+}
+
+void GpuTimer::end() {
+    if (openPass < 0) return;
+    std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - cpuStart;
+    frames[current].cpuMs[openPass] = elapsed.count();
+    if (gpuAvailable()) glQueryCounter(queries[current][openPass * 2 + 1], GL_TIMESTAMP);
+    openPass = -1;
+}
+
+void GpuTimer::resolve(int slot) {
+    FrameQueries& frame = frames[slot];
+    float gpuMs[MAX_PASSES] = {};
+    if (gpuAvailable() && frame.passCount > 0) {
+        // Queries complete in order: if the last one is done, all of them are
+        GLint available = 0;
+        glGetQueryObjectiv(queries[slot][frame.passCount * 2 - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            ++dropped;
+            return;
+        }
+        for (int p = 0; p < frame.passCount; ++p) {
+            GLuint64 t0 = 0, t1 = 0;
+            glGetQueryObjectui64v(queries[slot][p * 2], GL_QUERY_RESULT, &t0);
+            glGetQueryObjectui64v(queries[slot][p * 2 + 1], GL_QUERY_RESULT, &t1);
+            gpuMs[p] = t1 > t0 ? (float)((t1 - t0) / 1.0e6) : 0.0f;
+        }
+    }
+
+    for (PassStats& s : stats) s.gpuMaxMs *= PEAK_DECAY;
+    for (int p = 0; p < frame.passCount; ++p) {
+        PassStats& s = stats[frame.passIndex[p]];
+        s.gpuMs = gpuMs[p];
+        s.cpuMs = frame.cpuMs[p];
+        s.gpuAvgMs += (s.gpuMs - s.gpuAvgMs) * AVERAGE_WEIGHT;
+        s.cpuAvgMs += (s.cpuMs - s.cpuAvgMs) * AVERAGE_WEIGHT;
+        s.gpuMaxMs = std::max(s.gpuMaxMs, s.gpuMs);
+        if (csv) fprintf(csv, "%llu,%s,%.4f,%.4f\n", (unsigned long long)frame.number, s.name.c_str(), s.gpuMs, s.cpuMs);
+    }
+    ++resolved;
+}
+
+bool GpuTimer::startCsv(const std::string& path) {
+    stopCsv();
+    csv = fopen(path.c_str(), "w");
+    if (!csv) {
+        std::cerr << "No se pudo crear el registro de tiempos: " << path << std::endl;
+        return false;
+    }
+    fprintf(csv, "frame,pass,gpu_ms,cpu_ms\n");
+    return true;
+}
+
+void GpuTimer::stopCsv() {
+    if (!csv) return;
+    fclose(csv);
+    csv = nullptr;
+}
+
+bool GpuTimer::writeJson(const std::string& path) const {
+    FILE* out = fopen(path.c_str(), "w");
+    if (!out) return false;
+    fprintf(out, "{\n  \"frames\": %llu,\n  \"dropped\": %llu,\n  \"gpu\": %s,\n  \"passes\": [\n",
+            (unsigned long long)resolved, (unsigned long long)dropped, gpuAvailable() ? "true" : "false");
+    for (size_t i = 0; i < stats.size(); ++i) {
+        const PassStats& s = stats[i];
+        fprintf(out, "    {\"name\": \"%s\", \"gpu_ms\": %.4f, \"gpu_avg_ms\": %.4f, \"gpu_max_ms\": %.4f, "
+                     "\"cpu_ms\": %.4f, \"cpu_avg_ms\": %.4f}%s\n",
+                s.name.c_str(), s.gpuMs, s.gpuAvgMs, s.gpuMaxMs, s.cpuMs, s.cpuAvgMs,
+                i + 1 < stats.size() ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+    fclose(out);
+    return true;
+}
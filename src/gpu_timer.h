@@ -0,0 +1,75 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Per-pass GPU and CPU timings without stalling the pipeline. Each pass is
+// bracketed by two GL_TIMESTAMP queries (unlike GL_TIME_ELAPSED these
+// nest, so a pass can contain code that does its own elapsed-time query).
+// The queries of a frame live in a ring of FRAMES_IN_FLIGHT frames and are
+// read back when their slot comes around again, three frames later, and only
+// if the GPU has finished them. Otherwise the frame is dropped rather than
+// waited for.
+class GpuTimer {
+public:
+    static const int MAX_PASSES = 8;
+    static const int FRAMES_IN_FLIGHT = 3;
+
+    struct PassStats {
+        std::string name;
+        float gpuMs = 0.0f, cpuMs = 0.0f;         // last resolved frame
+        float gpuAvgMs = 0.0f, cpuAvgMs = 0.0f;   // exponential average
+        float gpuMaxMs = 0.0f;                     // peak over the last second or so
+    };
+
+    ~GpuTimer() { stopCsv(); }
+
+    // Needs a current GL context. Without timer queries only CPU times are kept.
+    void init();
+    void destroy();
+    bool gpuAvailable() const { return queries[0][0] != 0; }
+
+    // Start of every frame: collects the oldest frame's results if ready
+    void beginFrame();
+    // Brackets one pass; `name` must outlive the timer (string literal)
+    void begin(const char* name);
+    void end();
+
+    const std::vector<PassStats>& passes() const { return stats; }
+    uint64_t resolvedFrames() const { return resolved; }
+    uint64_t droppedFrames() const { return dropped; }
+
+    // Machine-readable output: one CSV row per pass of every resolved frame
+    // (frame,pass,gpu_ms,cpu_ms), or a JSON snapshot of the current stats
+    bool startCsv(const std::string& path);
+    void stopCsv();
+    bool csvActive() const { return csv != nullptr; }
+    bool writeJson(const std::string& path) const;
+
+private:
+    struct FrameQueries {
+        int passCount = 0;
+        int passIndex[MAX_PASSES] = {};
+        float cpuMs[MAX_PASSES] = {};
+        uint64_t number = 0;
+        bool recorded = false;
+    };
+
+    int statIndex(const char* name);
+    void resolve(int slot);
+
+    GLuint queries[FRAMES_IN_FLIGHT][MAX_PASSES * 2] = {};
+    FrameQueries frames[FRAMES_IN_FLIGHT];
+    std::vector<PassStats> stats;
+    std::vector<const char*> statNames;   // pointer identity first, strcmp on miss
+    int current = 0;
+    int openPass = -1;                    // slot inside the current frame
+    std::chrono::steady_clock::time_point cpuStart;
+    uint64_t frameNumber = 0;
+    uint64_t resolved = 0;
+    uint64_t dropped = 0;
+    FILE* csv = nullptr;
+};
@@ -0,0 +1,172 @@
+#include "instance_ring.h"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+    const GLuint64 FENCE_TIMEOUT_NS = 1000000; // re-flush every 1 ms while waiting
+
+    void waitFence(GLsync fence) {
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        while (true) {
+            GLenum result = glClientWaitSync(fence, flags, FENCE_TIMEOUT_NS);
+            if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED) break;
+            flags = 0;
+        }
+    }
+}
+
+void InstanceRing::init(size_t regionBytes, int regions) {
+    destroy();
+    regionCount = std::max(1, std::min(MAX_REGIONS, regions));
+    persistent = GLEW_ARB_buffer_storage || GLEW_VERSION_4_4;
+    create(regionBytes);
+}
+
+void InstanceRing::create(size_t regionBytes) {
+    regionSize = regionBytes;
+    region = 0;
+    head = 0;
+    regionReady = false;
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    if (persistent) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, regionSize * regionCount, nullptr, flags);
+        mapped = (char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, regionSize * regionCount, flags);
+        if (!mapped) {
+            // Immutable storage can't be respecified; start over on the fallback path
+            std::cerr << "Persistent mapping failed, using buffer orphaning" << std::endl;
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            glDeleteBuffers(1, &vbo);
+            persistent = false;
+            create(regionBytes);
+            return;
+        }
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, regionSize, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstanceRing::destroy() {
+    releaseRetired(true);
+    for (int r = 0; r < MAX_REGIONS; ++r) {
+        if (fences[r]) glDeleteSync(fences[r]);
+        fences[r] = nullptr;
+    }
+    if (vbo) {
+        if (mapped) {
+            glBindBuffer(GL_ARRAY_BUFFER, vbo);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+        glDeleteBuffers(1, &vbo);
+    }
+    vbo = 0;
+    mapped = nullptr;
+}
+
+void InstanceRing::waitRegion(int r) {
+    if (!fences[r]) return;
+    waitFence(fences[r]);
+    glDeleteSync(fences[r]);
+    fences[r] = nullptr;
+}
+
+void InstanceRing::retire() {
+    // Only one buffer waits at a time; a second grow in flight is rare
+    releaseRetired(true);
+    // The retire fence follows every region fence, so those are no longer needed
+    for (int r = 0; r < MAX_REGIONS; ++r) {
+        if (fences[r]) glDeleteSync(fences[r]);
+        fences[r] = nullptr;
+    }
+    if (mapped) {
+        retiredVbo = vbo;
+        retiredMapped = mapped;
+        retiredFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    } else if (vbo) {
+        // Unmapped storage: GL keeps it until the pending draws are done
+        glDeleteBuffers(1, &vbo);
+    }
+    vbo = 0;
+    mapped = nullptr;
+}
+
+void InstanceRing::releaseRetired(bool wait) {
+    if (!retiredVbo) return;
+    if (retiredFence) {
+        if (wait) {
+            waitFence(retiredFence);
+        } else {
+            GLenum result = glClientWaitSync(retiredFence, 0, 0);
+            if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED && result != GL_WAIT_FAILED) return;
+        }
+        glDeleteSync(retiredFence);
+        retiredFence = nullptr;
+    }
+    if (retiredMapped) {
+        glBindBuffer(GL_ARRAY_BUFFER, retiredVbo);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    glDeleteBuffers(1, &retiredVbo);
+    retiredVbo = 0;
+    retiredMapped = nullptr;
+}
+
+void* InstanceRing::allocate(size_t bytes, size_t alignment, size_t& offset) {
+    if (!vbo) return nullptr;
+    size_t start = (head + alignment - 1) / alignment * alignment;
+    if (start + bytes > regionSize) {
+        if (bytes > regionSize || persistent) {
+            // Grow so one frame always fits in a region. The new buffer is created
+            // before the old one is released: draws already issued this frame keep
+            // reading the old mapping until its fence signals.
+            size_t newSize = std::max(regionSize * 2, (start + bytes) * 2);
+            retire();
+            create(newSize);
+            start = 0;
+        } else {
+            // Fallback path: orphan the buffer once the frame's space runs out
+            glBindBuffer(GL_ARRAY_BUFFER, vbo);
+            glBufferData(GL_ARRAY_BUFFER, regionSize, nullptr, GL_STREAM_DRAW);
+            start = 0;
+        }
+    }
+    head = start + bytes;
+
+    if (persistent) {
+        if (!regionReady) {
+            waitRegion(region);
+            regionReady = true;
+        }
+        offset = region * regionSize + start;
+        return mapped + offset;
+    }
+
+    offset = start;
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    return glMapBufferRange(GL_ARRAY_BUFFER, start, bytes,
+                            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+}
+
+void InstanceRing::commit() {
+    if (!persistent && vbo) {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+}
+
+void InstanceRing::endFrame() {
+    if (persistent) {
+        if (regionReady) {
+            fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            region = (region + 1) % regionCount;
+        }
+        head = 0;
+        regionReady = false;
+        releaseRetired(false);
+    }
+    // The fallback path keeps appending and orphans when the buffer is full
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstddef>
+
+// Streaming buffer for per-instance vertex data. With ARB_buffer_storage it
+// is one persistently mapped, coherent buffer split into `regions` regions
+// (triple buffering by default): the CPU writes straight into the region of
+// the current frame while the GPU reads the previous ones, and a fence per
+// region keeps the CPU from overwriting data still in flight. Without the
+// extension it falls back to orphaning + unsynchronized map ranges.
+class InstanceRing {
+public:
+    ~InstanceRing() { destroy(); }
+
+    // Needs a current GL context. regionBytes grows on demand.
+    void init(size_t regionBytes, int regions = 3);
+    void destroy();
+
+    // Space for `bytes` in this frame's region, aligned to `alignment`.
+    // Returns the write pointer and the offset of the data in buffer().
+    void* allocate(size_t bytes, size_t alignment, size_t& offset);
+    // Must follow every allocate() (unmaps on the fallback path)
+    void commit();
+    // After the frame's last draw: fences the region and moves to the next
+    void endFrame();
+
+    GLuint buffer() const { return vbo; }
+    bool isPersistent() const { return persistent; }
+    size_t capacity() const { return regionSize; }
+
+private:
+    void create(size_t regionBytes);
+    void waitRegion(int region);
+    // Swaps out the current buffer on a mid-frame grow; a mapped one is kept
+    // alive until the GPU is past the draws already issued from it
+    void retire();
+    void releaseRetired(bool wait);
+
+    static const int MAX_REGIONS = 4;
+    GLuint vbo = 0;
+    bool persistent = false;
+    int regionCount = 3;
+    int region = 0;
+    size_t regionSize = 0;
+    size_t head = 0;            // write offset inside the current region
+    bool regionReady = false;   // fence of the current region already waited on
+    char* mapped = nullptr;     // persistent mapping of the whole buffer
+    GLsync fences[MAX_REGIONS] = {};
+    GLuint retiredVbo = 0;
+    char* retiredMapped = nullptr;
+    GLsync retiredFence = nullptr;
+};
@@ -0,0 +1,71 @@
+#include "latency_model.h"
+#include <cmath>
+#include <algorithm>
+
+namespace {
+    const float MEASURE_ALPHA = 0.05f; // EMA weight of each new measurement
+    const float DEFAULT_DISPLAY_SECONDS = 0.016f;
+    const double MAX_PHASE_ERROR = 0.35; // beats; farther observations are off-beat hits
+}
+
+const char* const latencyStageNames[LATENCY_STAGE_COUNT] = {
+    "Captura", "Análisis", "Render", "Swap", "Pantalla"
+};
+
+LatencyModel::LatencyModel() {
+    for (int s = 0; s < LATENCY_STAGE_COUNT; ++s) {
+        measured[s] = 0.0f;
+        manualSeconds[s] = 0.0f;
+        manual[s] = false;
+    }
+    // Scan-out can't be measured from here
+    manual[LATENCY_DISPLAY] = true;
+    manualSeconds[LATENCY_DISPLAY] = DEFAULT_DISPLAY_SECONDS;
+}
+
+void LatencyModel::measure(LatencyStage s, float seconds) {
+    if (!std::isfinite(seconds) || seconds < 0.0f) return;
+    measured[s] = measured[s] > 0.0f ? measured[s] + (seconds - measured[s]) * MEASURE_ALPHA : seconds;
+}
+
+void LatencyModel::setManual(LatencyStage s, bool enabled, float seconds) {
+    manual[s] = enabled;
+    manualSeconds[s] = std::max(0.0f, seconds);
+}
+
+float LatencyModel::stage(LatencyStage s) const {
+    return manual[s] ? manualSeconds[s] : measured[s];
+}
+
+void BeatScheduler::setTempo(float bpm, double time) {
+    double newPeriod = 60.0 / std::max(1.0f, bpm);
+    if (newPeriod == period) return;
+    // Keep the current phase continuous across tempo changes
+    double position = beatPosition(time);
+    reference = time - position * newPeriod;
+    period = newPeriod;
+}
+
+void BeatScheduler::observeBeat(double audioTime, float gain) {
+    double position = beatPosition(audioTime);
+    double error = position - std::round(position); // beats, -0.5..0.5
+    if (std::fabs(error) > MAX_PHASE_ERROR) return;
+    reference += error * period * gain;
+}
+
+float BeatScheduler::phaseAt(double time) const {
+    double position = beatPosition(time);
+    return (float)(position - std::floor(position));
+}
+
+bool BeatScheduler::advance(double position) {
+    triggered = started && std::floor(position) > std::floor(lastPosition);
+    lastPosition = position;
+    started = true;
+    return triggered;
+}
+
+float BeatScheduler::pulse(double position, float decayBeats) const {
+    double sinceBeat = position - std::floor(position);
+    return (float)std::exp(-sinceBeat / std::max(0.01f, decayBeats));
+}
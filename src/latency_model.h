@@ -0,0 +1,73 @@
+#pragma once
+
+// Stages between sound leaving the speakers and the matching photons
+enum LatencyStage {
+    LATENCY_CAPTURE = 0, // capture buffer + analysis block
+    LATENCY_ANALYSIS,    // FFT and feature extraction
+    LATENCY_RENDER,      // CPU work from frame start to swap
+    LATENCY_SWAP,        // buffer swap / vsync wait
+    LATENCY_DISPLAY,     // scan-out and panel response
+    LATENCY_STAGE_COUNT
+};
+
+extern const char* const latencyStageNames[LATENCY_STAGE_COUNT];
+
+// Per-stage latency: measured values are averaged, and any stage can be
+// overridden with a manual value (e.g. a display lag taken from a review).
+// Times in seconds.
+class LatencyModel {
+public:
+    LatencyModel();
+
+    void measure(LatencyStage stage, float seconds);
+    void setManual(LatencyStage stage, bool enabled, float seconds);
+
+    float stage(LatencyStage stage) const;
+    bool isManual(LatencyStage stage) const { return manual[stage]; }
+    float manualValue(LatencyStage stage) const { return manualSeconds[stage]; }
+
+    // How old the analyzed audio is when the frame starts
+    float inputDelay() const { return stage(LATENCY_CAPTURE) + stage(LATENCY_ANALYSIS); }
+    // How long until the frame started now reaches the screen
+    float visualLead() const { return stage(LATENCY_RENDER) + stage(LATENCY_SWAP) + stage(LATENCY_DISPLAY); }
+    float total() const { return inputDelay() + visualLead(); }
+
+private:
+    float measured[LATENCY_STAGE_COUNT];
+    float manualSeconds[LATENCY_STAGE_COUNT];
+    bool manual[LATENCY_STAGE_COUNT];
+};
+
+// Beat clock evaluated at display time. Events scheduled from it (beat
+// triggers, beat-phase animation) are computed for the moment the frame is
+// shown rather than the moment it is rendered, so they land on the beat.
+class BeatScheduler {
+public:
+    // The phase at `time` is kept across the change
+    void setTempo(float bpm, double time);
+    // Beat 0 falls at `time` (seconds on the audio clock), e.g. from a tap
+    void setReference(double time) { reference = time; restart(); }
+    // The next advance() only records its position: call when the beat
+    // position jumps (new reference, switch to another beat source)
+    void restart() { started = false; }
+    // Pull the phase toward a beat heard at `audioTime` (e.g. a kick); ignored
+    // when it is far from the grid
+    void observeBeat(double audioTime, float gain = 0.2f);
+
+    double beatPosition(double time) const { return (time - reference) / period; }
+    float phaseAt(double time) const;
+
+    // Once per frame with the beat position at display time; true when a new
+    // beat started since the previous frame
+    bool advance(double position);
+    bool beatThisFrame() const { return triggered; }
+    // 0-1 pulse that decays from the last beat (display time)
+    float pulse(double position, float decayBeats = 0.25f) const;
+
+private:
+    double period = 0.5;
+    double reference = 0.0;
+    double lastPosition = 0.0;
+    bool started = false;
+    bool triggered = false;
+};
@@ -0,0 +1,155 @@
+#include "line_renderer.h"
+#include "shader_utils.h"
+#include <cmath>
+#include <iostream>
+
+namespace {
+    const char* LINE_VERTEX_SHADER = R"(
+#version 330 core
+layout(location = 0) in vec2 aCorner;     // x: 0 start / 1 end, y: -1 / +1 side
+layout(location = 2) in vec2 aOffset;
+layout(location = 3) in float aAngle;
+layout(location = 4) in vec2 aScale;
+layout(location = 6) in vec4 aColorLeft;  // start of every segment
+layout(location = 7) in vec4 aColorRight; // end of every segment
+layout(location = 8) in float aWidth;     // pixels
+out vec2 vPx;                             // pixels along / across the segment
+flat out float vLength;
+flat out float vHalfWidth;
+flat out float vCoverage;
+out vec3 vColor;
+uniform vec4 uSegments[6];                // unit-shape endpoints (xy -> zw)
+uniform int uSegmentCount;
+uniform float uAspect;
+uniform vec2 uViewport;
+
+vec2 toPixels(vec2 p) {
+    float s = sin(aAngle);
+    float c = cos(aAngle);
+    mat2 rot = mat2(c, -s, s, c);
+    vec2 pos = rot * (p * aScale) + aOffset;
+    pos.x /= uAspect;
+    return pos * 0.5 * uViewport;
+}
+
+void main() {
+    vec4 seg = uSegments[gl_InstanceID % uSegmentCount];
+    vec2 a = toPixels(seg.xy);
+    vec2 b = toPixels(seg.zw);
+    float len = length(b - a);
+    vec2 dir = len > 1e-4 ? (b - a) / len : vec2(1.0, 0.0);
+    vec2 nrm = vec2(-dir.y, dir.x);
+
+    // Lines thinner than a pixel keep a one-pixel footprint and fade instead
+    float width = max(aWidth, 0.0);
+    float halfWidth = max(0.5 * width, 0.5);
+    float ext = halfWidth + 1.0;
+    float along = aCorner.x * len + (aCorner.x * 2.0 - 1.0) * ext;
+    float across = aCorner.y * ext;
+    vec2 px = a + dir * along + nrm * across;
+    gl_Position = vec4(px / (0.5 * uViewport), 0.0, 1.0);
+
+    vPx = vec2(along, across);
+    vLength = len;
+    vHalfWidth = halfWidth;
+    vCoverage = min(width, 1.0);
+    vColor = mix(aColorLeft.rgb, aColorRight.rgb, aCorner.x);
+}
+)";
+
+    const char* LINE_FRAGMENT_SHADER = R"(
+#version 330 core
+in vec2 vPx;
+flat in float vLength;
+flat in float vHalfWidth;
+flat in float vCoverage;
+in vec3 vColor;
+out vec4 FragColor;
+void main() {
+    // Distance to the segment (round caps), in pixels
+    float dx = max(max(-vPx.x, vPx.x - vLength), 0.0);
+    float d = length(vec2(dx, vPx.y)) - vHalfWidth;
+    float alpha = clamp(0.5 - d, 0.0, 1.0) * vCoverage;
+    if (alpha <= 0.0) discard;
+    FragColor = vec4(vColor, alpha);
+}
+)";
+
+    // Same endpoints as the line meshes of buildShapeVertices at unit size
+    void shapeSegments(int shapeType, float out[LineRenderer::MAX_SEGMENTS * 4]) {
+        if (shapeType == SHAPE_LONG_LINES) {
+            for (int i = 0; i < 6; ++i) {
+                float angle = (float)i * (float)M_PI / 6.0f;
+                float x = 0.5f * cosf(angle);
+                float y = 0.5f * sinf(angle);
+                out[i * 4 + 0] = -x; out[i * 4 + 1] = -y;
+                out[i * 4 + 2] = x;  out[i * 4 + 3] = y;
+            }
+        } else {
+            out[0] = -0.5f; out[1] = 0.0f;
+            out[2] = 0.5f;  out[3] = 0.0f;
+        }
+    }
+}
+
+bool LineRenderer::init() {
+    destroy();
+    GLuint p = createShaderProgram(LINE_VERTEX_SHADER, LINE_FRAGMENT_SHADER);
+    GLint linked = 0;
+    glGetProgramiv(p, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        std::cerr << "Líneas gruesas no disponibles, se usa GL_LINES" << std::endl;
+        glDeleteProgram(p);
+        return false;
+    }
+    program = p;
+    uAspect = glGetUniformLocation(program, "uAspect");
+    uViewport = glGetUniformLocation(program, "uViewport");
+    uSegments = glGetUniformLocation(program, "uSegments");
+    uSegmentCount = glGetUniformLocation(program, "uSegmentCount");
+
+    const float corners[8] = {0.0f, -1.0f,  1.0f, -1.0f,  0.0f, 1.0f,  1.0f, 1.0f};
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    for (int a = 2; a <= 8; ++a) glEnableVertexAttribArray(a);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    lastDivisor = -1;
+    return true;
+}
+
+void LineRenderer::destroy() {
+    if (program) glDeleteProgram(program);
+    if (vao) glDeleteVertexArrays(1, &vao);
+    if (vbo) glDeleteBuffers(1, &vbo);
+    program = vao = vbo = 0;
+}
+
+void LineRenderer::bind(int shapeType, float aspect, int viewportWidth, int viewportHeight) {
+    float segments[MAX_SEGMENTS * 4] = {};
+    shapeSegments(shapeType, segments);
+    boundSegments = segmentCount(shapeType);
+
+    glUseProgram(program);
+    glUniform1f(uAspect, aspect);
+    glUniform2f(uViewport, (float)viewportWidth, (float)viewportHeight);
+    glUniform4fv(uSegments, boundSegments, segments);
+    glUniform1i(uSegmentCount, boundSegments);
+
+    glBindVertexArray(vao);
+    // Each shape's attributes cover all of its segments
+    if (lastDivisor != boundSegments) {
+        for (int a = 2; a <= 8; ++a) glVertexAttribDivisor(a, boundSegments);
+        lastDivisor = boundSegments;
+    }
+}
+
+void LineRenderer::draw(GLsizei instanceCount) {
+    if (instanceCount > 0) glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, instanceCount * boundSegments);
+    glBindVertexArray(0);
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <GL/glew.h>
+#include "shape_types.h"
+
+// Thick anti-aliased lines without glLineWidth / GL_LINE_SMOOTH (core
+// profiles clamp the width and many drivers ignore the smoothing). Every
+// segment of a line shape is one GPU instance: the vertex shader moves the
+// segment to pixel space and expands it into a quad of the instance's
+// width (plus one pixel for the ramp), and the fragment shader computes
+// the distance to the segment with round caps for the coverage.
+//
+// Uses the per-instance attributes of the main shader (locations 2-7) and
+// the width at location 8. They advance once every segmentCount() GPU
+// instances, so several shapes are drawn in the same call.
+class LineRenderer {
+public:
+    static const int MAX_SEGMENTS = 6;
+
+    // Needs a current GL context
+    bool init();
+    void destroy();
+    bool ready() const { return program != 0; }
+
+    static bool supports(int shapeType) { return shapeType == SHAPE_LINE || shapeType == SHAPE_LONG_LINES; }
+    static int segmentCount(int shapeType) { return shapeType == SHAPE_LONG_LINES ? 6 : 1; }
+
+    // Binds program and VAO. The caller then points attributes 2-8 at its
+    // instance data and calls draw() with the number of shapes.
+    void bind(int shapeType, float aspect, int viewportWidth, int viewportHeight);
+    void draw(GLsizei instanceCount);
+
+private:
+    GLuint program = 0;
+    GLuint vao = 0;
+    GLuint vbo = 0;
+    int boundSegments = 1;
+    int lastDivisor = -1;
+    GLint uAspect = -1, uViewport = -1, uSegments = -1, uSegmentCount = -1;
+};
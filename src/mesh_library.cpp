@@ -0,0 +1,98 @@
+#include "mesh_library.h"
+#include "triangle_utils.h"
+#include <algorithm>
+
+namespace {
+    const int FLOATS_PER_VERTEX = 6; // x,y,z + corner weights
+    const float IDENTITY_WEIGHTS[9] = {1.0f, 0.0f, 0.0f,  0.0f, 1.0f, 0.0f,  0.0f, 0.0f, 1.0f};
+
+    // Primitive buildShapeVertices emits for each shape
+    GLenum primitiveFor(int shapeType) {
+        switch (shapeType) {
+            case SHAPE_SQUARE: return GL_TRIANGLE_STRIP;
+            case SHAPE_CIRCLE: return GL_TRIANGLE_FAN;
+            case SHAPE_LINE:
+            case SHAPE_LONG_LINES: return GL_LINES;
+            default: return GL_TRIANGLES;
+        }
+    }
+
+    // Strips and fans become plain triangles so that all filled shapes share
+    // GL_TRIANGLES and can go in the same multi-draw
+    void appendAsTriangles(std::vector<float>& out, const std::vector<float>& in, GLenum mode) {
+        int n = (int)(in.size() / FLOATS_PER_VERTEX);
+        auto copyVertex = [&](int v) {
+            out.insert(out.end(), in.begin() + v * FLOATS_PER_VERTEX, in.begin() + (v + 1) * FLOATS_PER_VERTEX);
+        };
+        if (mode == GL_TRIANGLE_STRIP) {
+            for (int i = 0; i + 2 < n; ++i) {
+                // Keep the winding consistent on odd triangles
+                if (i % 2 == 0) { copyVertex(i); copyVertex(i + 1); copyVertex(i + 2); }
+                else { copyVertex(i + 1); copyVertex(i); copyVertex(i + 2); }
+            }
+        } else if (mode == GL_TRIANGLE_FAN) {
+            for (int i = 1; i + 1 < n; ++i) {
+                copyVertex(0); copyVertex(i); copyVertex(i + 1);
+            }
+        } else {
+            out.insert(out.end(), in.begin(), in.end());
+        }
+    }
+}
+
+bool MeshLibrary::init() {
+    destroy();
+    std::vector<float> vertices;
+    std::vector<float> shape;
+    auto append = [&](int shapeType, int nSegments) {
+        MeshRange r;
+        r.first = (GLint)(vertices.size() / FLOATS_PER_VERTEX);
+        shape.clear();
+        buildShapeVertices(shape, shapeType, 1.0f, IDENTITY_WEIGHTS, IDENTITY_WEIGHTS + 3, IDENTITY_WEIGHTS + 6, nSegments);
+        GLenum mode = primitiveFor(shapeType);
+        appendAsTriangles(vertices, shape, mode);
+        r.count = (GLsizei)(vertices.size() / FLOATS_PER_VERTEX) - r.first;
+        r.mode = mode == GL_LINES ? GL_LINES : GL_TRIANGLES;
+        return r;
+    };
+
+    for (int s = 0; s < SHAPE_COUNT; ++s) {
+        if (s != SHAPE_CIRCLE) shapes[s] = append(s, 0);
+    }
+    circles.clear();
+    for (int n = MIN_CIRCLE_SEGMENTS; n <= MAX_CIRCLE_SEGMENTS; ++n) {
+        circles.push_back(append(SHAPE_CIRCLE, n));
+    }
+    shapes[SHAPE_CIRCLE] = circles[32 - MIN_CIRCLE_SEGMENTS];
+
+    totalBytes = vertices.size() * sizeof(float);
+    glGenVertexArrays(1, &vertexArray);
+    glGenBuffers(1, &vertexBuffer);
+    glBindVertexArray(vertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, totalBytes, vertices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    return vertexArray != 0 && vertexBuffer != 0;
+}
+
+void MeshLibrary::destroy() {
+    if (vertexArray) glDeleteVertexArrays(1, &vertexArray);
+    if (vertexBuffer) glDeleteBuffers(1, &vertexBuffer);
+    vertexArray = 0;
+    vertexBuffer = 0;
+    totalBytes = 0;
+}
+
+MeshRange MeshLibrary::range(int shapeType, int nSegments) const {
+    if (shapeType == SHAPE_CIRCLE && !circles.empty()) {
+        int n = std::max((int)MIN_CIRCLE_SEGMENTS, std::min((int)MAX_CIRCLE_SEGMENTS, nSegments));
+        return circles[n - MIN_CIRCLE_SEGMENTS];
+    }
+    if (shapeType < 0 || shapeType >= SHAPE_COUNT) return shapes[SHAPE_TRIANGLE];
+    return shapes[shapeType];
+}
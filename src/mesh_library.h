@@ -0,0 +1,42 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstddef>
+#include <vector>
+#include "shape_types.h"
+
+// A run of vertices inside a vertex buffer, drawn with one primitive mode
+struct MeshRange {
+    GLint first = 0;
+    GLsizei count = 0;
+    GLenum mode = GL_TRIANGLES;
+};
+
+// Every base shape generated once at unit size in a single static VBO:
+// triangle, square, line, long lines and circles of every segment count.
+// Size comes from the instance scale, so nothing is rebuilt at runtime.
+// Vertex colors are corner weights (see cornerWeights in main.cpp). Filled
+// shapes are stored as GL_TRIANGLES and lines as GL_LINES, so any mix of
+// shapes can be submitted with one multi-draw per primitive.
+class MeshLibrary {
+public:
+    static const int MIN_CIRCLE_SEGMENTS = 3;
+    static const int MAX_CIRCLE_SEGMENTS = 256;
+
+    // Needs a current GL context. Sets up attributes 0 (position) and 1 (corner weights).
+    bool init();
+    void destroy();
+
+    GLuint vao() const { return vertexArray; }
+    GLuint vbo() const { return vertexBuffer; }
+    size_t bytes() const { return totalBytes; }
+
+    // nSegments only matters for circles and is clamped to the supported range
+    MeshRange range(int shapeType, int nSegments) const;
+
+private:
+    GLuint vertexArray = 0;
+    GLuint vertexBuffer = 0;
+    size_t totalBytes = 0;
+    MeshRange shapes[SHAPE_COUNT];
+    std::vector<MeshRange> circles; // index = segments - MIN_CIRCLE_SEGMENTS
+};
@@ -0,0 +1,144 @@
+#include "modulation_matrix.h"
+#include <cmath>
+#include <algorithm>
+
+const char* const modSourceNames[MOD_SRC_COUNT] = {
+    "Bass", "Low Mid", "Mid", "High Mid", "Treble", "Overall", "Peak", "RMS",
+    "Centroide", "Planitud", "Rolloff", "Flujo", "ZCR",
+    "Chroma C", "Chroma C#", "Chroma D", "Chroma D#", "Chroma E", "Chroma F",
+    "Chroma F#", "Chroma G", "Chroma G#", "Chroma A", "Chroma A#", "Chroma B",
+    "Env Bass", "Env Low Mid", "Env Mid", "Env High Mid", "Env Treble",
+    "Kick", "Snare", "Hi-hat", "Pitch", "Confianza Pitch",
+    "Beat", "Fase Beat"
+};
+
+const char* const modDestNames[MOD_DST_COUNT] = {
+    "Tamaño", "Rotación", "Ángulo", "Mover X", "Mover Y", "Escala X", "Escala Y",
+    "Intensidad Color", "Segmentos", "Ángulo Grupo", "Cantidad Objetos", "Tono (Hue)"
+};
+
+const char* const modCurveNames[MOD_CURVE_COUNT] = {
+    "Lineal", "Exponencial", "Logarítmica", "Smoothstep", "Invertida"
+};
+
+namespace {
+    const ModDestInfo destInfo[MOD_DST_COUNT] = {
+        // name                           defMin  defMax   clampMin clampMax perObject
+        {modDestNames[MOD_DST_SIZE],            0.1f,   2.0f,    0.01f,   10.0f,  true},
+        {modDestNames[MOD_DST_ROTATION],        0.0f,   500.0f,  0.0f,    2000.0f, true},
+        {modDestNames[MOD_DST_ANGLE],           0.0f,   360.0f,  -3600.0f, 3600.0f, true},
+        {modDestNames[MOD_DST_TRANSLATE_X],     -1.0f,  1.0f,    -5.0f,   5.0f,   true},
+        {modDestNames[MOD_DST_TRANSLATE_Y],     -1.0f,  1.0f,    -5.0f,   5.0f,   true},
+        {modDestNames[MOD_DST_SCALE_X],         0.1f,   3.0f,    0.01f,   10.0f,  true},
+        {modDestNames[MOD_DST_SCALE_Y],         0.1f,   3.0f,    0.01f,   10.0f,  true},
+        {modDestNames[MOD_DST_COLOR_INTENSITY], 0.0f,   2.0f,    0.0f,    5.0f,   true},
+        {modDestNames[MOD_DST_SEGMENTS],        3.0f,   64.0f,   3.0f,    128.0f, true},
+        {modDestNames[MOD_DST_GROUP_ANGLE],     0.0f,   360.0f,  -3600.0f, 3600.0f, false},
+        {modDestNames[MOD_DST_NUM_OBJECTS],     0.0f,   50.0f,   0.0f,    100.0f, false},
+        {modDestNames[MOD_DST_HUE],             0.0f,   360.0f,  0.0f,    360.0f, true},
+    };
+
+    // Source values above this are treated as clipping
+    const float MAX_SOURCE = 10.0f;
+
+    inline float shape(uint8_t curve, float x) {
+        switch (curve) {
+            case MOD_CURVE_EXP: {
+                x = std::min(1.0f, x);
+                return x * x * x;
+            }
+            case MOD_CURVE_LOG: {
+                x = std::min(1.0f, x);
+                return std::log1p(9.0f * x) / std::log(10.0f);
+            }
+            case MOD_CURVE_SMOOTHSTEP: {
+                x = std::min(1.0f, x);
+                return x * x * (3.0f - 2.0f * x);
+            }
+            case MOD_CURVE_INVERTED:
+                return 1.0f - std::min(1.0f, x);
+            default:
+                return x;
+        }
+    }
+}
+
+const ModDestInfo& modDestInfo(int dest) {
+    return destInfo[dest];
+}
+
+int ModulationMatrix::addRoute(int g, ModSource src, ModDest dst, float sens,
+                               float minV, float maxV, ModCurve c, bool on) {
+    source.push_back(src);
+    dest.push_back(dst);
+    group.push_back((uint8_t)g);
+    curve.push_back(c);
+    enabled.push_back(on ? 1 : 0);
+    sensitivity.push_back(sens);
+    minValue.push_back(minV);
+    maxValue.push_back(maxV);
+    return size() - 1;
+}
+
+void ModulationMatrix::removeRoute(int index) {
+    source.erase(source.begin() + index);
+    dest.erase(dest.begin() + index);
+    group.erase(group.begin() + index);
+    curve.erase(curve.begin() + index);
+    enabled.erase(enabled.begin() + index);
+    sensitivity.erase(sensitivity.begin() + index);
+    minValue.erase(minValue.begin() + index);
+    maxValue.erase(maxValue.begin() + index);
+}
+
+void ModulationMatrix::removeRoutes(int g, ModDest dst) {
+    for (int i = size() - 1; i >= 0; --i) {
+        if (group[i] == g && dest[i] == dst) removeRoute(i);
+    }
+}
+
+int ModulationMatrix::findRoute(int g, ModDest dst) const {
+    for (int i = 0; i < size(); ++i) {
+        if (group[i] == g && dest[i] == dst) return i;
+    }
+    return -1;
+}
+
+void ModulationMatrix::clear() {
+    source.clear();
+    dest.clear();
+    group.clear();
+    curve.clear();
+    enabled.clear();
+    sensitivity.clear();
+    minValue.clear();
+    maxValue.clear();
+}
+
+void ModulationMatrix::evaluate(const float* sources, int numGroups, float* targets, uint8_t* active) const {
+    const int slots = numGroups * MOD_DST_COUNT;
+    std::fill(targets, targets + slots, 0.0f);
+    std::fill(active, active + slots, 0);
+
+    // Sanitize the sources once instead of per route
+    float src[MOD_SRC_COUNT];
+    for (int s = 0; s < MOD_SRC_COUNT; ++s) {
+        float v = sources[s];
+        src[s] = std::isfinite(v) ? std::max(0.0f, std::min(MAX_SOURCE, v)) : 0.0f;
+    }
+
+    const int n = size();
+    for (int i = 0; i < n; ++i) {
+        if (!enabled[i] || group[i] >= numGroups) continue;
+        float x = shape(curve[i], src[source[i]] * sensitivity[i]);
+        int slot = group[i] * MOD_DST_COUNT + dest[i];
+        targets[slot] += minValue[i] + (maxValue[i] - minValue[i]) * x;
+        active[slot] = 1;
+    }
+
+    for (int slot = 0; slot < slots; ++slot) {
+        const ModDestInfo& info = destInfo[slot % MOD_DST_COUNT];
+        float v = targets[slot];
+        targets[slot] = std::isfinite(v) ? std::max(info.clampMin, std::min(info.clampMax, v)) : info.clampMin;
+    }
+}
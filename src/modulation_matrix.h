@@ -0,0 +1,102 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+// Analysis features that can drive a parameter. Values are written into a flat
+// float array indexed by ModSource before evaluate() is called.
+enum ModSource : uint8_t {
+    MOD_SRC_BASS = 0,
+    MOD_SRC_LOW_MID,
+    MOD_SRC_MID,
+    MOD_SRC_HIGH_MID,
+    MOD_SRC_TREBLE,
+    MOD_SRC_OVERALL,
+    MOD_SRC_PEAK,
+    MOD_SRC_RMS,
+    MOD_SRC_CENTROID,
+    MOD_SRC_FLATNESS,
+    MOD_SRC_ROLLOFF,
+    MOD_SRC_FLUX,
+    MOD_SRC_ZCR,
+    MOD_SRC_CHROMA_C,  // 12 consecutive pitch classes, C to B
+    MOD_SRC_CHROMA_B = MOD_SRC_CHROMA_C + 11,
+    MOD_SRC_ENV_BASS,  // peak-held band envelopes, bass to treble
+    MOD_SRC_ENV_TREBLE = MOD_SRC_ENV_BASS + 4,
+    MOD_SRC_KICK,
+    MOD_SRC_SNARE,
+    MOD_SRC_HAT,
+    MOD_SRC_PITCH,             // pitch C2..C6 as 0-1
+    MOD_SRC_PITCH_CONFIDENCE,
+    MOD_SRC_BEAT,              // latency-compensated beat pulse, 1 on the beat
+    MOD_SRC_BEAT_PHASE,        // 0-1 through the beat
+    MOD_SRC_COUNT
+};
+
+// Object / group parameters that can be modulated
+enum ModDest : uint8_t {
+    MOD_DST_SIZE = 0,
+    MOD_DST_ROTATION,
+    MOD_DST_ANGLE,
+    MOD_DST_TRANSLATE_X,
+    MOD_DST_TRANSLATE_Y,
+    MOD_DST_SCALE_X,
+    MOD_DST_SCALE_Y,
+    MOD_DST_COLOR_INTENSITY,
+    MOD_DST_SEGMENTS,
+    MOD_DST_GROUP_ANGLE,
+    MOD_DST_NUM_OBJECTS,
+    MOD_DST_HUE,               // degrees, absolute hue of the object colors
+    MOD_DST_COUNT
+};
+
+// Shaping applied to the (sensitivity scaled) source before mapping to [min, max]
+enum ModCurve : uint8_t {
+    MOD_CURVE_LINEAR = 0, // unbounded, same as the old controls
+    MOD_CURVE_EXP,
+    MOD_CURVE_LOG,
+    MOD_CURVE_SMOOTHSTEP,
+    MOD_CURVE_INVERTED,
+    MOD_CURVE_COUNT
+};
+
+struct ModDestInfo {
+    const char* name;
+    float defaultMin, defaultMax; // range for new routes
+    float clampMin, clampMax;     // hard limits of the destination
+    bool perObject;               // false: applies to the group itself
+};
+
+extern const char* const modSourceNames[MOD_SRC_COUNT];
+extern const char* const modDestNames[MOD_DST_COUNT];
+extern const char* const modCurveNames[MOD_CURVE_COUNT];
+const ModDestInfo& modDestInfo(int dest);
+
+// Routing table stored as parallel arrays (one entry per route). evaluate()
+// walks it once per frame for every group and sums the routes that share a
+// destination, so any source can drive any parameter.
+class ModulationMatrix {
+public:
+    int addRoute(int group, ModSource src, ModDest dst, float sensitivity,
+                 float minValue, float maxValue, ModCurve curve = MOD_CURVE_LINEAR, bool enabled = true);
+    void removeRoute(int index);
+    void removeRoutes(int group, ModDest dst);
+    // First route of a group targeting dst, -1 if none
+    int findRoute(int group, ModDest dst) const;
+    void clear();
+    int size() const { return (int)source.size(); }
+
+    // sources: MOD_SRC_COUNT values. targets/active: numGroups * MOD_DST_COUNT
+    // entries, indexed group * MOD_DST_COUNT + dest. Results are finite and
+    // clamped to the destination limits.
+    void evaluate(const float* sources, int numGroups, float* targets, uint8_t* active) const;
+
+    // Route table, editable in place by the UI
+    std::vector<uint8_t> source;
+    std::vector<uint8_t> dest;
+    std::vector<uint8_t> group;
+    std::vector<uint8_t> curve;
+    std::vector<uint8_t> enabled;
+    std::vector<float> sensitivity;
+    std::vector<float> minValue;
+    std::vector<float> maxValue;
+};
@@ -0,0 +1,528 @@
+#include "offline_analyzer.h"
+#include "fft_utils.h"
+#include "band_envelope.h"
+#include "profiler.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+    const char CACHE_MAGIC[4] = {'V', 'C', 'A', 'N'};
+    const uint32_t CACHE_VERSION = 1;
+
+    const float MIN_BPM = 60.0f;
+    const float MAX_BPM = 200.0f;
+    const float PRIOR_BPM = 120.0f;       // tempo prior, one octave wide
+    const float BEAT_TIGHTNESS = 100.0f;  // penalty for beat intervals off the tempo
+    const int BEATS_PER_BAR = 4;
+    const int SECTION_WINDOW_BARS = 4;    // bars compared on each side of a boundary
+    const int MIN_SECTION_BARS = 8;
+
+    struct CacheHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t analysisSize;
+        float sampleRate;
+        int32_t fftSize;
+        int32_t hop;
+        uint64_t sourceSize;
+        int64_t sourceTime;
+        uint64_t frameCount;
+        uint64_t beatCount;
+        uint64_t sectionCount;
+        float bpm;
+        int32_t downbeat;
+    };
+
+    uint32_t readLE32(const unsigned char* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+    uint16_t readLE16(const unsigned char* p) { return p[0] | (p[1] << 8); }
+
+    // Mono float samples in [-1, 1], the same scale the capture thread feeds the analysis
+    bool readWav(const std::string& path, std::vector<float>& mono, float& sampleRate) {
+        FILE* f = fopen(path.c_str(), "rb");
+        if (!f) return false;
+        std::vector<unsigned char> bytes;
+        fseek(f, 0, SEEK_END);
+        long size = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        if (size > 12) {
+            bytes.resize(size);
+            if (fread(bytes.data(), 1, size, f) != (size_t)size) bytes.clear();
+        }
+        fclose(f);
+        if (bytes.size() < 12 || memcmp(bytes.data(), "RIFF", 4) != 0 || memcmp(bytes.data() + 8, "WAVE", 4) != 0) {
+            return false;
+        }
+
+        int format = 0, channels = 0, bits = 0;
+        const unsigned char* data = nullptr;
+        size_t dataSize = 0;
+        size_t pos = 12;
+        while (pos + 8 <= bytes.size()) {
+            const unsigned char* chunk = bytes.data() + pos;
+            size_t chunkSize = readLE32(chunk + 4);
+            size_t available = std::min(chunkSize, bytes.size() - pos - 8);
+            if (memcmp(chunk, "fmt ", 4) == 0 && available >= 16) {
+                format = readLE16(chunk + 8);
+                channels = readLE16(chunk + 10);
+                sampleRate = (float)readLE32(chunk + 12);
+                bits = readLE16(chunk + 22);
+                // WAVE_FORMAT_EXTENSIBLE: the real format is the start of the subformat GUID
+                if (format == 0xFFFE && available >= 26) format = readLE16(chunk + 32);
+            } else if (memcmp(chunk, "data", 4) == 0) {
+                data = chunk + 8;
+                dataSize = available;
+            }
+            pos += 8 + chunkSize + (chunkSize & 1);
+        }
+        bool pcm = format == 1 && (bits == 16 || bits == 24 || bits == 32);
+        bool ieee = format == 3 && bits == 32;
+        if (!data || channels <= 0 || sampleRate <= 0.0f || (!pcm && !ieee)) return false;
+
+        int bytesPerSample = bits / 8;
+        size_t frames = dataSize / (bytesPerSample * channels);
+        mono.resize(frames);
+        const float scale = 1.0f / channels;
+        for (size_t i = 0; i < frames; ++i) {
+            float sum = 0.0f;
+            for (int c = 0; c < channels; ++c) {
+                const unsigned char* p = data + (i * channels + c) * bytesPerSample;
+                float v;
+                if (ieee) {
+                    uint32_t u = readLE32(p);
+                    memcpy(&v, &u, sizeof(float));
+                } else if (bits == 16) {
+                    v = (int16_t)readLE16(p) / 32768.0f;
+                } else if (bits == 24) {
+                    int32_t s = (int32_t)((p[0] << 8) | (p[1] << 16) | ((uint32_t)p[2] << 24));
+                    v = s / 2147483648.0f;
+                } else {
+                    v = (int32_t)readLE32(p) / 2147483648.0f;
+                }
+                sum += v;
+            }
+            mono[i] = sum * scale;
+        }
+        return true;
+    }
+
+    // Spectral features for frames [begin, end). The frame before `begin` is
+    // analyzed first so the flux of the first frame matches a sequential run.
+    void analyzeFrameRange(const std::vector<float>& mono, float sampleRate, int fftSize, int hop,
+                           size_t begin, size_t end, std::vector<AudioAnalysis>& frames) {
+        PROFILE_ZONE("Análisis offline: FFT");
+        FFTUtils fft(fftSize);
+        AudioFeatureExtractor extractor(sampleRate);
+        std::vector<float> window(fftSize);
+        AudioAnalysis scratch;
+        const long half = fftSize / 2;
+        for (size_t i = begin > 0 ? begin - 1 : 0; i < end; ++i) {
+            // Centered window, zero-padded past either end of the track
+            long start = (long)i * hop - half;
+            for (int j = 0; j < fftSize; ++j) {
+                long s = start + j;
+                window[j] = (s >= 0 && s < (long)mono.size()) ? mono[s] : 0.0f;
+            }
+            std::vector<float> spectrum = fft.compute(window);
+            AudioAnalysis& target = i >= begin ? frames[i] : scratch;
+            extractor.analyze(spectrum, window, target);
+        }
+    }
+
+    // Band envelopes sampled at the frame centers. Run once forward and once
+    // over the reversed track: averaging both cancels the filter lag, and the
+    // reversed peak hold anticipates transients.
+    void envelopePass(const std::vector<float>& mono, float sampleRate, int hop, bool reversed,
+                      size_t frameCount, std::vector<float>& env, std::vector<float>& peak) {
+        PROFILE_ZONE("Análisis offline: envolventes");
+        BandEnvelopeBank bank(sampleRate);
+        env.assign(frameCount * ENVELOPE_BANDS, 0.0f);
+        peak.assign(frameCount * ENVELOPE_BANDS, 0.0f);
+        std::vector<float> chunk;
+        size_t n = mono.size();
+        size_t processed = 0; // samples fed so far, in pass order
+        for (size_t k = 0; k < frameCount; ++k) {
+            size_t i = reversed ? frameCount - 1 - k : k;
+            size_t center = std::min(n, i * (size_t)hop);
+            // Position of the frame center in pass order, inclusive
+            size_t target = reversed ? n - center : center + 1;
+            target = std::min(target, n);
+            if (target > processed) {
+                chunk.resize(target - processed);
+                for (size_t s = 0; s < chunk.size(); ++s) {
+                    size_t idx = processed + s;
+                    chunk[s] = reversed ? mono[n - 1 - idx] : mono[idx];
+                }
+                bank.process(chunk.data(), (int)chunk.size());
+                processed = target;
+            }
+            bank.read(&env[i * ENVELOPE_BANDS], &peak[i * ENVELOPE_BANDS]);
+        }
+    }
+
+    // Onset strength from spectral flux with the local mean removed
+    std::vector<float> onsetStrength(const std::vector<AudioAnalysis>& frames) {
+        size_t n = frames.size();
+        std::vector<float> onset(n, 0.0f);
+        const int radius = 16;
+        double sum = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            size_t a = i > (size_t)radius ? i - radius : 0;
+            size_t b = std::min(n, i + radius + 1);
+            float mean = 0.0f;
+            for (size_t j = a; j < b; ++j) mean += frames[j].flux;
+            mean /= (float)(b - a);
+            onset[i] = std::max(0.0f, frames[i].flux - mean);
+            sum += onset[i] * onset[i];
+        }
+        float norm = n > 0 ? (float)std::sqrt(sum / n) : 0.0f;
+        if (norm > 0.0f) {
+            for (float& v : onset) v /= norm;
+        }
+        return onset;
+    }
+
+    // Beat period in frames: onset autocorrelation weighted by a tempo prior
+    float estimatePeriod(const std::vector<float>& onset, float frameRate) {
+        int minLag = std::max(1, (int)(frameRate * 60.0f / MAX_BPM));
+        int maxLag = (int)(frameRate * 60.0f / MIN_BPM) + 1;
+        int n = (int)onset.size();
+        if (n <= maxLag + 1) return frameRate * 60.0f / PRIOR_BPM;
+
+        float priorLag = frameRate * 60.0f / PRIOR_BPM;
+        std::vector<float> score(maxLag + 2, 0.0f);
+        int best = minLag;
+        for (int lag = minLag; lag <= maxLag + 1; ++lag) {
+            double ac = 0.0;
+            for (int i = 0; i + lag < n; ++i) ac += onset[i] * onset[i + lag];
+            float octaves = std::log2((float)lag / priorLag);
+            score[lag] = (float)(ac / (n - lag)) * std::exp(-0.5f * octaves * octaves);
+            if (lag <= maxLag && score[lag] > score[best]) best = lag;
+        }
+        float lag = (float)best;
+        if (best > minLag && best < maxLag) {
+            float a = score[best - 1], b = score[best], c = score[best + 1];
+            float denom = a - 2.0f * b + c;
+            if (denom < 0.0f) lag += 0.5f * (a - c) / denom;
+        }
+        return lag;
+    }
+
+    // Dynamic-programming beat tracker (Ellis 2007): maximizes onset strength
+    // at the beats while penalizing intervals that stray from the period
+    std::vector<int> trackBeats(const std::vector<float>& onset, float period) {
+        int n = (int)onset.size();
+        std::vector<int> beats;
+        if (n == 0 || period < 1.0f) return beats;
+
+        std::vector<float> cumulative(n);
+        std::vector<int> backlink(n, -1);
+        int searchStart = (int)std::round(period * 2.0f);
+        int searchEnd = std::max(1, (int)std::round(period * 0.5f));
+        for (int i = 0; i < n; ++i) {
+            float best = 0.0f;
+            int bestJ = -1;
+            for (int j = std::max(0, i - searchStart); j <= i - searchEnd; ++j) {
+                float deviation = std::log((float)(i - j) / period);
+                float score = cumulative[j] - BEAT_TIGHTNESS * deviation * deviation;
+                if (bestJ < 0 || score > best) {
+                    best = score;
+                    bestJ = j;
+                }
+            }
+            cumulative[i] = onset[i] + (bestJ >= 0 ? std::max(0.0f, best) : 0.0f);
+            backlink[i] = bestJ >= 0 && best > 0.0f ? bestJ : -1;
+        }
+
+        // Last beat: the best cumulative score within the final period
+        int last = n - 1;
+        for (int i = std::max(0, n - (int)std::ceil(period)); i < n; ++i) {
+            if (cumulative[i] > cumulative[last]) last = i;
+        }
+        for (int i = last; i >= 0; i = backlink[i]) beats.push_back(i);
+        std::reverse(beats.begin(), beats.end());
+        return beats;
+    }
+
+    // Bar boundaries where the mean timbre/harmony of the following bars
+    // differs most from the preceding ones
+    std::vector<double> findSections(const OfflineAnalysis& a) {
+        std::vector<double> sections = {0.0};
+        std::vector<double> barStart;
+        for (size_t k = a.downbeat; k < a.beats.size(); k += BEATS_PER_BAR) barStart.push_back(a.beats[k]);
+        int bars = (int)barStart.size() - 1;
+        if (bars < SECTION_WINDOW_BARS * 2) return sections;
+
+        const int DIMS = 5 + 12;
+        std::vector<float> features(bars * DIMS, 0.0f);
+        for (int b = 0; b < bars; ++b) {
+            size_t f0 = (size_t)(barStart[b] * a.sampleRate / a.hop);
+            size_t f1 = std::min(a.frames.size(), (size_t)(barStart[b + 1] * a.sampleRate / a.hop));
+            float* row = &features[b * DIMS];
+            for (size_t f = f0; f < f1; ++f) {
+                const AudioAnalysis& fr = a.frames[f];
+                const float bands[5] = {fr.bass, fr.lowMid, fr.mid, fr.highMid, fr.treble};
+                for (int d = 0; d < 5; ++d) row[d] += std::log1p(bands[d]);
+                for (int d = 0; d < 12; ++d) row[5 + d] += fr.chroma[d];
+            }
+            float count = (float)std::max<size_t>(1, f1 - f0);
+            for (int d = 0; d < DIMS; ++d) row[d] /= count;
+        }
+        // Standardize each dimension so no feature dominates the distance
+        for (int d = 0; d < DIMS; ++d) {
+            float mean = 0.0f, var = 0.0f;
+            for (int b = 0; b < bars; ++b) mean += features[b * DIMS + d];
+            mean /= bars;
+            for (int b = 0; b < bars; ++b) {
+                float v = features[b * DIMS + d] - mean;
+                var += v * v;
+            }
+            float inv = var > 0.0f ? 1.0f / std::sqrt(var / bars) : 0.0f;
+            for (int b = 0; b < bars; ++b) features[b * DIMS + d] = (features[b * DIMS + d] - mean) * inv;
+        }
+
+        const int W = SECTION_WINDOW_BARS;
+        std::vector<float> novelty(bars, 0.0f);
+        for (int b = W; b <= bars - W; ++b) {
+            float dist = 0.0f;
+            for (int d = 0; d < DIMS; ++d) {
+                float before = 0.0f, after = 0.0f;
+                for (int k = 0; k < W; ++k) {
+                    before += features[(b - 1 - k) * DIMS + d];
+                    after += features[(b + k) * DIMS + d];
+                }
+                float diff = (after - before) / W;
+                dist += diff * diff;
+            }
+            novelty[b] = std::sqrt(dist);
+        }
+        float mean = 0.0f, var = 0.0f;
+        for (float v : novelty) mean += v;
+        mean /= bars;
+        for (float v : novelty) var += (v - mean) * (v - mean);
+        float threshold = mean + std::sqrt(var / bars);
+
+        int lastBoundary = 0;
+        for (int b = W; b <= bars - W; ++b) {
+            bool localMax = novelty[b] >= novelty[b - 1] && (b + 1 >= bars || novelty[b] >= novelty[b + 1]);
+            if (localMax && novelty[b] > threshold && b - lastBoundary >= MIN_SECTION_BARS) {
+                sections.push_back(barStart[b]);
+                lastBoundary = b;
+            }
+        }
+        return sections;
+    }
+
+    bool sourceStamp(const std::string& path, uint64_t& size, int64_t& time) {
+        std::error_code ec;
+        size = std::filesystem::file_size(path, ec);
+        if (ec) return false;
+        auto t = std::filesystem::last_write_time(path, ec);
+        if (ec) return false;
+        time = (int64_t)t.time_since_epoch().count();
+        return true;
+    }
+}
+
+double OfflineAnalysis::duration() const {
+    return hop > 0 && sampleRate > 0.0f ? (double)frames.size() * hop / sampleRate : 0.0;
+}
+
+const AudioAnalysis& OfflineAnalysis::frameAt(double t) const {
+    static const AudioAnalysis silence;
+    if (frames.empty()) return silence;
+    long i = std::lround(t * sampleRate / hop);
+    i = std::max(0L, std::min((long)frames.size() - 1, i));
+    return frames[i];
+}
+
+double OfflineAnalysis::beatPositionAt(double t) const {
+    if (beats.size() < 2) return 0.0;
+    double period = 60.0 / std::max(1.0f, bpm);
+    size_t k = std::upper_bound(beats.begin(), beats.end(), t) - beats.begin();
+    if (k == 0) {
+        // Before the first beat: extrapolate the grid backwards
+        return (t - beats[0]) / period;
+    }
+    if (k >= beats.size()) {
+        return (double)(beats.size() - 1) + (t - beats.back()) / period;
+    }
+    double length = beats[k] - beats[k - 1];
+    return (double)(k - 1) + (length > 0.0 ? (t - beats[k - 1]) / length : 0.0);
+}
+
+float OfflineAnalysis::beatPhaseAt(double t) const {
+    double position = beatPositionAt(t);
+    return (float)(position - std::floor(position));
+}
+
+float OfflineAnalysis::barPhaseAt(double t) const {
+    double position = beatPositionAt(t);
+    long k = (long)std::floor(position);
+    long inBar = ((k - downbeat) % BEATS_PER_BAR + BEATS_PER_BAR) % BEATS_PER_BAR;
+    return (inBar + (float)(position - k)) / BEATS_PER_BAR;
+}
+
+int OfflineAnalysis::sectionAt(double t) const {
+    if (sections.empty()) return 0;
+    return std::max(0, (int)(std::upper_bound(sections.begin(), sections.end(), t) - sections.begin()) - 1);
+}
+
+bool analyzeAudioFile(const std::string& path, OfflineAnalysis& out, int fftSize, int hop, int threads) {
+    std::vector<float> mono;
+    float sampleRate = 0.0f;
+    if (!readWav(path, mono, sampleRate)) {
+        std::cerr << "No se pudo leer el WAV: " << path << std::endl;
+        return false;
+    }
+
+    OfflineAnalysis result;
+    result.sampleRate = sampleRate;
+    result.fftSize = fftSize;
+    result.hop = hop;
+    size_t frameCount = mono.size() / hop + 1;
+    result.frames.resize(frameCount);
+
+    // Spectral frames split across the cores, envelopes in both directions
+    // on two more threads
+    if (threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    threads = (int)std::min<size_t>(threads, frameCount);
+    std::vector<float> envForward, peakForward, envBackward, peakBackward;
+    std::vector<std::thread> workers;
+    size_t perThread = (frameCount + threads - 1) / threads;
+    for (int t = 0; t < threads; ++t) {
+        size_t begin = t * perThread;
+        size_t end = std::min(frameCount, begin + perThread);
+        if (begin >= end) break;
+        workers.emplace_back(analyzeFrameRange, std::cref(mono), sampleRate, fftSize, hop, begin, end,
+                             std::ref(result.frames));
+    }
+    workers.emplace_back(envelopePass, std::cref(mono), sampleRate, hop, false, frameCount,
+                         std::ref(envForward), std::ref(peakForward));
+    workers.emplace_back(envelopePass, std::cref(mono), sampleRate, hop, true, frameCount,
+                         std::ref(envBackward), std::ref(peakBackward));
+    for (auto& w : workers) w.join();
+
+    for (size_t i = 0; i < frameCount; ++i) {
+        for (int b = 0; b < ENVELOPE_BANDS; ++b) {
+            size_t k = i * ENVELOPE_BANDS + b;
+            result.frames[i].envelope[b] = 0.5f * (envForward[k] + envBackward[k]);
+            result.frames[i].envelopePeak[b] = std::max(peakForward[k], peakBackward[k]);
+        }
+    }
+
+    // Beat grid
+    float frameRate = sampleRate / hop;
+    std::vector<float> onset = onsetStrength(result.frames);
+    float period = estimatePeriod(onset, frameRate);
+    std::vector<int> beatFrames = trackBeats(onset, period);
+    for (int f : beatFrames) result.beats.push_back((double)f / frameRate);
+    if (result.beats.size() >= 2) {
+        // Mean interval over the whole grid; single intervals are quantized to the hop
+        double span = result.beats.back() - result.beats.front();
+        result.bpm = (float)(60.0 * (result.beats.size() - 1) / span);
+    } else {
+        result.bpm = 60.0f * frameRate / period;
+    }
+
+    // Downbeat: the beat position in the bar with the most low-end energy
+    float bestScore = -1.0f;
+    for (int p = 0; p < BEATS_PER_BAR && p < (int)beatFrames.size(); ++p) {
+        float score = 0.0f;
+        for (size_t k = p; k < beatFrames.size(); k += BEATS_PER_BAR) score += result.frames[beatFrames[k]].envelopePeak[0];
+        if (score > bestScore) {
+            bestScore = score;
+            result.downbeat = p;
+        }
+    }
+    result.sections = findSections(result);
+
+    out = std::move(result);
+    return true;
+}
+
+std::string offlineCachePath(const std::string& path) {
+    return path + ".vcan";
+}
+
+bool saveOfflineAnalysis(const std::string& sourcePath, const OfflineAnalysis& a) {
+    CacheHeader header = {};
+    if (!sourceStamp(sourcePath, header.sourceSize, header.sourceTime)) return false;
+    FILE* f = fopen(offlineCachePath(sourcePath).c_str(), "wb");
+    if (!f) return false;
+    memcpy(header.magic, CACHE_MAGIC, 4);
+    header.version = CACHE_VERSION;
+    header.analysisSize = sizeof(AudioAnalysis);
+    header.sampleRate = a.sampleRate;
+    header.fftSize = a.fftSize;
+    header.hop = a.hop;
+    header.frameCount = a.frames.size();
+    header.beatCount = a.beats.size();
+    header.sectionCount = a.sections.size();
+    header.bpm = a.bpm;
+    header.downbeat = a.downbeat;
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    ok = ok && fwrite(a.beats.data(), sizeof(double), a.beats.size(), f) == a.beats.size();
+    ok = ok && fwrite(a.sections.data(), sizeof(double), a.sections.size(), f) == a.sections.size();
+    ok = ok && fwrite(a.frames.data(), sizeof(AudioAnalysis), a.frames.size(), f) == a.frames.size();
+    fclose(f);
+    return ok;
+}
+
+bool loadOfflineAnalysis(const std::string& sourcePath, OfflineAnalysis& a) {
+    uint64_t size;
+    int64_t time;
+    if (!sourceStamp(sourcePath, size, time)) return false;
+    std::string cachePath = offlineCachePath(sourcePath);
+    std::error_code ec;
+    uint64_t fileSize = std::filesystem::file_size(cachePath, ec);
+    if (ec) return false;
+    FILE* f = fopen(cachePath.c_str(), "rb");
+    if (!f) return false;
+    CacheHeader header;
+    bool ok = fread(&header, sizeof(header), 1, f) == 1 &&
+              memcmp(header.magic, CACHE_MAGIC, 4) == 0 && header.version == CACHE_VERSION &&
+              header.analysisSize == sizeof(AudioAnalysis) &&
+              header.sourceSize == size && header.sourceTime == time &&
+              header.hop > 0 && header.fftSize > 0 && header.sampleRate > 0.0f;
+    // The counts must describe exactly the rest of the file: a corrupt header
+    // is treated as a stale cache instead of sizing the vectors from it
+    if (ok) {
+        uint64_t payload = fileSize - sizeof(header);
+        ok = header.beatCount <= payload / sizeof(double) &&
+             header.sectionCount <= payload / sizeof(double) &&
+             header.frameCount <= payload / sizeof(AudioAnalysis) &&
+             (header.beatCount + header.sectionCount) * sizeof(double) +
+                 header.frameCount * sizeof(AudioAnalysis) == payload;
+    }
+    OfflineAnalysis result;
+    if (ok) {
+        result.sampleRate = header.sampleRate;
+        result.fftSize = header.fftSize;
+        result.hop = header.hop;
+        result.bpm = header.bpm;
+        result.downbeat = header.downbeat;
+        result.beats.resize(header.beatCount);
+        result.sections.resize(header.sectionCount);
+        result.frames.resize(header.frameCount);
+        ok = fread(result.beats.data(), sizeof(double), result.beats.size(), f) == result.beats.size() &&
+             fread(result.sections.data(), sizeof(double), result.sections.size(), f) == result.sections.size() &&
+             fread(result.frames.data(), sizeof(AudioAnalysis), result.frames.size(), f) == result.frames.size();
+    }
+    fclose(f);
+    if (ok) a = std::move(result);
+    return ok;
+}
+
+bool loadOrAnalyzeAudioFile(const std::string& path, OfflineAnalysis& out) {
+    if (loadOfflineAnalysis(path, out)) return true;
+    if (!analyzeAudioFile(path, out)) return false;
+    if (!saveOfflineAnalysis(path, out)) {
+        std::cerr << "No se pudo escribir la caché: " << offlineCachePath(path) << std::endl;
+    }
+    return true;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "audio_analysis.h"
+
+// Non-causal analysis of a whole track, computed ahead of playback. Frames
+// use windows centered on their timestamp, so at playback time the renderer
+// reads them with no lookahead latency. Pitch and drum events come from the
+// live capture and are left at zero here.
+struct OfflineAnalysis {
+    float sampleRate = 0.0f;
+    int fftSize = 0;
+    int hop = 0;                          // samples between frames
+    std::vector<AudioAnalysis> frames;    // frame i is centered at i * hop / sampleRate
+
+    // Beat grid
+    float bpm = 0.0f;
+    std::vector<double> beats;            // seconds
+    int downbeat = 0;                     // index of the first beat that starts a bar
+    std::vector<double> sections;         // section start times, sections[0] == 0
+
+    bool empty() const { return frames.empty(); }
+    double duration() const;
+    const AudioAnalysis& frameAt(double t) const;
+    // Beats since the first grid beat (fractional, extrapolated outside the grid)
+    double beatPositionAt(double t) const;
+    // 0-1 position inside the current beat / 4-beat bar
+    float beatPhaseAt(double t) const;
+    float barPhaseAt(double t) const;
+    int sectionAt(double t) const;
+};
+
+// Analyzes a WAV file (PCM 16/24/32 bit or float) on all cores.
+// threads <= 0 uses std::thread::hardware_concurrency().
+bool analyzeAudioFile(const std::string& path, OfflineAnalysis& out,
+                      int fftSize = 1024, int hop = 512, int threads = 0);
+
+// Sidecar cache next to the source file (<path>.vcan). The cache stores the
+// source size and modification time and is ignored when they change.
+std::string offlineCachePath(const std::string& path);
+bool saveOfflineAnalysis(const std::string& sourcePath, const OfflineAnalysis& analysis);
+bool loadOfflineAnalysis(const std::string& sourcePath, OfflineAnalysis& analysis);
+
+// Loads the sidecar when it is current, otherwise analyzes and writes it
+bool loadOrAnalyzeAudioFile(const std::string& path, OfflineAnalysis& out);
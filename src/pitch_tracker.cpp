@@ -0,0 +1,131 @@
+#include "pitch_tracker.h"
+#include "profiler.h"
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+
+namespace {
+    const float MAX_PITCH_HZ = 2000.0f;
+    const float SILENCE_ENERGY = 1e-6f; // per sample, below this nothing is tracked
+}
+
+PitchTracker::PitchTracker(float sampleRate, int windowSize, int hopSize)
+    : sampleRate(sampleRate), windowSize(windowSize), hop(hopSize), threshold(0.15f),
+      pitchHz(0.0f), pitchConfidence(0.0f), analysisMs(0.0f) {
+    int integration = windowSize / 2;
+    minLag = std::max(2, (int)(sampleRate / MAX_PITCH_HZ));
+    maxLag = integration - 1;
+
+    history.assign(windowSize, 0.0f);
+    frame.resize(windowSize);
+    prefixEnergy.resize(windowSize + 1);
+    diff.resize(integration);
+    windowIn.resize(windowSize);
+    windowSpec.resize(windowSize);
+    headIn.resize(windowSize);
+    headSpec.resize(windowSize);
+    corr.resize(windowSize);
+
+    forward = kiss_fft_alloc(windowSize, 0, nullptr, nullptr);
+    inverse = kiss_fft_alloc(windowSize, 1, nullptr, nullptr);
+}
+
+PitchTracker::~PitchTracker() {
+    if (forward) kiss_fft_free(forward);
+    if (inverse) kiss_fft_free(inverse);
+}
+
+void PitchTracker::process(const float* samples, int count) {
+    int hopSize = std::max(64, std::min(windowSize, hop.load(std::memory_order_relaxed)));
+    for (int i = 0; i < count; ++i) {
+        history[writePos] = samples[i];
+        writePos = (writePos + 1) & (windowSize - 1);
+        if (++sinceLastHop >= hopSize) {
+            sinceLastHop = 0;
+            analyze();
+        }
+    }
+}
+
+void PitchTracker::analyze() {
+    PROFILE_ZONE("Pitch (YIN)");
+    auto start = std::chrono::steady_clock::now();
+    const int W = windowSize;
+    const int T = W / 2; // YIN integration window
+
+    // Oldest sample first
+    for (int j = 0; j < W; ++j) frame[j] = history[(writePos + j) & (W - 1)];
+
+    prefixEnergy[0] = 0.0f;
+    for (int j = 0; j < W; ++j) prefixEnergy[j + 1] = prefixEnergy[j] + frame[j] * frame[j];
+    float energy0 = prefixEnergy[T];
+
+    float hz = pitchHz.load(std::memory_order_relaxed);
+    float confidence = 0.0f;
+    if (energy0 > SILENCE_ENERGY * T) {
+        // Cross-correlation of the first T samples against the whole window:
+        // c(tau) = sum_j x[j] x[j + tau]. For tau < T nothing wraps, so a
+        // circular correlation of size W is exact.
+        for (int j = 0; j < W; ++j) {
+            windowIn[j].r = frame[j];
+            windowIn[j].i = 0.0f;
+            headIn[j].r = j < T ? frame[j] : 0.0f;
+            headIn[j].i = 0.0f;
+        }
+        kiss_fft(forward, windowIn.data(), windowSpec.data());
+        kiss_fft(forward, headIn.data(), headSpec.data());
+        for (int k = 0; k < W; ++k) {
+            // conj(head) * window
+            float ar = headSpec[k].r, ai = -headSpec[k].i;
+            float br = windowSpec[k].r, bi = windowSpec[k].i;
+            windowIn[k].r = ar * br - ai * bi;
+            windowIn[k].i = ar * bi + ai * br;
+        }
+        kiss_fft(inverse, windowIn.data(), corr.data());
+        const float scale = 1.0f / W;
+
+        // Cumulative mean normalized difference d'(tau)
+        diff[0] = 1.0f;
+        float runningSum = 0.0f;
+        for (int tau = 1; tau <= maxLag; ++tau) {
+            float energyTau = prefixEnergy[tau + T] - prefixEnergy[tau];
+            float d = std::max(0.0f, energy0 + energyTau - 2.0f * corr[tau].r * scale);
+            runningSum += d;
+            diff[tau] = runningSum > 0.0f ? d * tau / runningSum : 1.0f;
+        }
+
+        // First dip under the threshold, then down to its local minimum
+        float thr = threshold.load(std::memory_order_relaxed);
+        int best = -1;
+        for (int tau = minLag; tau <= maxLag; ++tau) {
+            if (diff[tau] < thr) {
+                while (tau + 1 <= maxLag && diff[tau + 1] < diff[tau]) ++tau;
+                best = tau;
+                break;
+            }
+        }
+
+        if (best > 0) {
+            // Parabolic interpolation around the minimum
+            float lag = (float)best;
+            if (best > 1 && best < maxLag) {
+                float a = diff[best - 1], b = diff[best], c = diff[best + 1];
+                float denom = a - 2.0f * b + c;
+                if (denom > 0.0f) lag += 0.5f * (a - c) / denom;
+            }
+            hz = sampleRate / lag;
+            confidence = std::max(0.0f, std::min(1.0f, 1.0f - diff[best]));
+        }
+    }
+
+    pitchHz.store(hz, std::memory_order_relaxed);
+    pitchConfidence.store(confidence, std::memory_order_relaxed);
+    std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    analysisMs.store(elapsed.count(), std::memory_order_relaxed);
+}
+
+void PitchTracker::read(float& hz, float& confidence, float& midi) const {
+    hz = pitchHz.load(std::memory_order_relaxed);
+    confidence = pitchConfidence.load(std::memory_order_relaxed);
+    midi = hz > 0.0f ? 69.0f + 12.0f * std::log2(hz / 440.0f) : 0.0f;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include "../kissfft/kiss_fft.h"
+
+// Monophonic pitch tracker (YIN). The difference function is built from an
+// FFT cross-correlation, so one analysis costs three FFTs of the window size
+// instead of O(W^2). Runs on the capture thread every `hop` samples and
+// publishes the result through atomics.
+class PitchTracker {
+public:
+    // windowSize must be a power of two; the lowest detectable pitch is
+    // sampleRate / (windowSize / 2)
+    PitchTracker(float sampleRate = 48000.0f, int windowSize = 2048, int hop = 512);
+    ~PitchTracker();
+    PitchTracker(const PitchTracker&) = delete;
+    PitchTracker& operator=(const PitchTracker&) = delete;
+
+    // Capture thread: feed mono samples, analyzes whenever a hop is complete
+    void process(const float* samples, int count);
+
+    // Any thread
+    void setHop(int samples) { hop.store(samples, std::memory_order_relaxed); }
+    void setThreshold(float t) { threshold.store(t, std::memory_order_relaxed); }
+    // Last voiced pitch (held while unvoiced), confidence 0-1, MIDI note
+    // (fractional) and the time the last analysis took
+    void read(float& hz, float& confidence, float& midi) const;
+    float lastAnalysisMs() const { return analysisMs.load(std::memory_order_relaxed); }
+
+private:
+    void analyze();
+
+    float sampleRate;
+    int windowSize;
+    int minLag, maxLag;
+    std::atomic<int> hop;
+    std::atomic<float> threshold;
+
+    std::vector<float> history; // circular, windowSize samples
+    int writePos = 0;
+    int sinceLastHop = 0;
+
+    kiss_fft_cfg forward = nullptr;
+    kiss_fft_cfg inverse = nullptr;
+    std::vector<kiss_fft_cpx> windowIn, windowSpec, headIn, headSpec, corr;
+    std::vector<float> frame, prefixEnergy, diff;
+
+    std::atomic<float> pitchHz;
+    std::atomic<float> pitchConfidence;
+    std::atomic<float> analysisMs;
+};
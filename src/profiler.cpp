@@ -0,0 +1,178 @@
+#include "profiler.h"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace profiler {
+    std::atomic<bool> enabledFlag{false};
+}
+
+namespace {
+    const size_t RING_CAPACITY = 1 << 16;   // events per thread (~1.5 MB)
+
+    struct Event {
+        const char* name;
+        uint64_t start;
+        uint64_t end;
+    };
+
+    struct ThreadRing {
+        std::vector<Event> events;
+        std::atomic<uint64_t> head{0};     // total events written
+        std::atomic<bool> inUse{true};
+        std::string name;
+        int tid = 0;
+    };
+
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+
+    // Reference point for converting ticks to trace microseconds
+    uint64_t originTicks = 0;
+    std::chrono::steady_clock::time_point originTime;
+    std::once_flag originOnce;
+
+    void setOrigin() {
+        originTicks = profiler::now();
+        originTime = std::chrono::steady_clock::now();
+    }
+
+    // A thread's ring goes back to the pool when the thread exits, so short-lived
+    // workers (offline analysis) don't grow the registry
+    struct RingHandle {
+        ThreadRing* ring = nullptr;
+        ~RingHandle() {
+            if (ring) ring->inUse.store(false, std::memory_order_release);
+        }
+    };
+    thread_local RingHandle threadRing;
+
+    ThreadRing* acquireRing() {
+        if (threadRing.ring) return threadRing.ring;
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (auto& r : rings) {
+            if (!r->inUse.load(std::memory_order_acquire)) {
+                r->inUse.store(true, std::memory_order_relaxed);
+                // Drop the previous owner's zones so they are not exported under
+                // the new thread's tid and name (export holds the same lock)
+                r->head.store(0, std::memory_order_release);
+                r->name.clear();
+                threadRing.ring = r.get();
+                return r.get();
+            }
+        }
+        std::unique_ptr<ThreadRing> r(new ThreadRing());
+        r->events.resize(RING_CAPACITY);
+        r->tid = (int)rings.size() + 1;
+        threadRing.ring = r.get();
+        rings.push_back(std::move(r));
+        return threadRing.ring;
+    }
+
+    double ticksPerUs() {
+#if defined(__x86_64__) || defined(__i386__)
+        // TSC rate from the ticks elapsed since the origin; wait a little if the
+        // interval is too short to be accurate
+        auto elapsedUs = [] {
+            return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - originTime).count();
+        };
+        while (elapsedUs() < 2000.0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        uint64_t ticks = profiler::now();
+        double us = elapsedUs();
+        return (double)(ticks - originTicks) / us;
+#else
+        return 1000.0;
+#endif
+    }
+
+    void writeEscaped(FILE* out, const std::string& s) {
+        for (char c : s) {
+            if (c == '"' || c == '\\') fputc('\\', out);
+            fputc(c, out);
+        }
+    }
+}
+
+namespace profiler {
+
+void setEnabled(bool on) {
+    if (on) std::call_once(originOnce, setOrigin);
+    enabledFlag.store(on, std::memory_order_relaxed);
+}
+
+void setThreadName(const char* name) {
+    ThreadRing* ring = acquireRing();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    ring->name = name;
+}
+
+void record(const char* name, uint64_t start, uint64_t end) {
+    ThreadRing* ring = acquireRing();
+    uint64_t h = ring->head.load(std::memory_order_relaxed);
+    ring->events[h & (RING_CAPACITY - 1)] = Event{name, start, end};
+    ring->head.store(h + 1, std::memory_order_release);
+}
+
+double ticksToMs(uint64_t ticks) {
+#if defined(__x86_64__) || defined(__i386__)
+    static const double ticksPerMs = [] {
+        std::call_once(originOnce, setOrigin);
+        return ticksPerUs() * 1000.0;
+    }();
+    return ticks / ticksPerMs;
+#else
+    return ticks / 1.0e6;
+#endif
+}
+
+bool writeChromeTrace(const std::string& path) {
+    std::call_once(originOnce, setOrigin);
+    double perUs = ticksPerUs();
+    FILE* out = fopen(path.c_str(), "w");
+    if (!out) return false;
+    fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    auto separator = [&] {
+        if (!first) fprintf(out, ",\n");
+        first = false;
+    };
+
+    std::vector<Event> snapshot;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (auto& ring : rings) {
+        if (!ring->name.empty()) {
+            separator();
+            fprintf(out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"", ring->tid);
+            writeEscaped(out, ring->name);
+            fprintf(out, "\"}}");
+        }
+
+        // Copy without stopping the writer, then drop whatever it may have
+        // overwritten during the copy
+        uint64_t before = ring->head.load(std::memory_order_acquire);
+        uint64_t begin = before > RING_CAPACITY ? before - RING_CAPACITY : 0;
+        snapshot.clear();
+        for (uint64_t i = begin; i < before; ++i) snapshot.push_back(ring->events[i & (RING_CAPACITY - 1)]);
+        uint64_t after = ring->head.load(std::memory_order_acquire);
+        uint64_t firstValid = after >= RING_CAPACITY ? after - RING_CAPACITY + 1 : 0;
+
+        for (uint64_t i = begin; i < before; ++i) {
+            if (i < firstValid) continue;
+            const Event& e = snapshot[i - begin];
+            if (e.start < originTicks || e.end < e.start) continue;
+            separator();
+            fprintf(out, "{\"name\":\"");
+            writeEscaped(out, e.name);
+            fprintf(out, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    ring->tid, (e.start - originTicks) / perUs, (e.end - e.start) / perUs);
+        }
+    }
+    fprintf(out, "\n]}\n");
+    fclose(out);
+    return true;
+}
+
+}
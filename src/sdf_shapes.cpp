@@ -0,0 +1,178 @@
+#include "sdf_shapes.h"
+#include "shader_utils.h"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+    const char* SDF_VERTEX_SHADER = R"(
+#version 330 core
+layout(location = 0) in vec2 aCorner;     // quad corner in [-1, 1]
+layout(location = 2) in vec2 aOffset;
+layout(location = 3) in float aAngle;
+layout(location = 4) in vec2 aScale;
+layout(location = 5) in vec4 aColorTop;
+layout(location = 6) in vec4 aColorLeft;
+layout(location = 7) in vec4 aColorRight;
+out vec2 vLocal;
+flat out vec3 vColorTop;
+flat out vec3 vColorLeft;
+flat out vec3 vColorRight;
+uniform float uAspect;
+uniform float uExtent;                    // half size of the quad in unit-shape units
+void main() {
+    float s = sin(aAngle);
+    float c = cos(aAngle);
+    mat2 rot = mat2(c, -s, s, c);
+    vLocal = aCorner * uExtent;
+    vec2 pos = rot * (vLocal * aScale) + aOffset;
+    pos.x /= uAspect;
+    gl_Position = vec4(pos, 0.0, 1.0);
+    vColorTop = aColorTop.rgb;
+    vColorLeft = aColorLeft.rgb;
+    vColorRight = aColorRight.rgb;
+}
+)";
+
+    // Distances follow the unit meshes of buildShapeVertices (size 1)
+    const char* SDF_FRAGMENT_SHADER = R"(
+#version 330 core
+in vec2 vLocal;
+flat in vec3 vColorTop;
+flat in vec3 vColorLeft;
+flat in vec3 vColorRight;
+out vec4 FragColor;
+uniform int uShape;       // 0 triangle, 1 square, 2 circle
+uniform int uSides;       // > 0: circle drawn as a regular polygon
+uniform float uStroke;    // 0 = filled
+const float PI = 3.14159265;
+const vec2 T0 = vec2(0.0, 1.0 / 3.0);
+const vec2 T1 = vec2(-0.5, -2.0 / 3.0);
+const vec2 T2 = vec2(0.5, -2.0 / 3.0);
+
+float sdTriangle(vec2 p) {
+    vec2 e0 = T1 - T0, e1 = T2 - T1, e2 = T0 - T2;
+    vec2 v0 = p - T0, v1 = p - T1, v2 = p - T2;
+    vec2 pq0 = v0 - e0 * clamp(dot(v0, e0) / dot(e0, e0), 0.0, 1.0);
+    vec2 pq1 = v1 - e1 * clamp(dot(v1, e1) / dot(e1, e1), 0.0, 1.0);
+    vec2 pq2 = v2 - e2 * clamp(dot(v2, e2) / dot(e2, e2), 0.0, 1.0);
+    float s = sign(e0.x * e2.y - e0.y * e2.x);
+    vec2 d = min(min(vec2(dot(pq0, pq0), s * (v0.x * e0.y - v0.y * e0.x)),
+                     vec2(dot(pq1, pq1), s * (v1.x * e1.y - v1.y * e1.x))),
+                     vec2(dot(pq2, pq2), s * (v2.x * e2.y - v2.y * e2.x)));
+    return -sqrt(d.x) * sign(d.y);
+}
+
+float sdBox(vec2 p, vec2 b) {
+    vec2 d = abs(p) - b;
+    return length(max(d, 0.0)) + min(max(d.x, d.y), 0.0);
+}
+
+// Regular polygon with a vertex on +x, like the circle mesh
+float sdPolygon(vec2 p, float r, int n) {
+    float an = PI / float(n);
+    vec2 acs = vec2(cos(an), sin(an));
+    float bn = mod(atan(p.y, p.x) + 2.0 * PI, 2.0 * an) - an;
+    p = length(p) * vec2(cos(bn), abs(sin(bn)));
+    p -= r * acs;
+    p.y += clamp(-p.y, 0.0, r * acs.y);
+    return length(p) * sign(p.x);
+}
+
+// Blend weights of the three corner colors, as the mesh vertices carry them
+vec3 cornerWeights(vec2 p) {
+    if (uShape == 0) {
+        float area = (T1.y - T2.y) * (T0.x - T2.x) + (T2.x - T1.x) * (T0.y - T2.y);
+        float a = ((T1.y - T2.y) * (p.x - T2.x) + (T2.x - T1.x) * (p.y - T2.y)) / area;
+        float b = ((T2.y - T0.y) * (p.x - T2.x) + (T0.x - T2.x) * (p.y - T2.y)) / area;
+        return clamp(vec3(a, b, 1.0 - a - b), 0.0, 1.0);
+    }
+    if (uShape == 1) {
+        float t = clamp(p.y + 0.5, 0.0, 1.0);
+        return vec3(t, 0.5 * (1.0 - t), 0.5 * (1.0 - t));
+    }
+    // Circle: top -> left -> right around the rim, their average at the center
+    float t = fract(atan(p.y, p.x) / (2.0 * PI)) * 3.0;
+    vec3 rim = t < 1.0 ? vec3(1.0 - t, t, 0.0)
+             : (t < 2.0 ? vec3(0.0, 2.0 - t, t - 1.0) : vec3(t - 2.0, 0.0, 3.0 - t));
+    float r = clamp(length(p) * 2.0, 0.0, 1.0);
+    return mix(vec3(1.0 / 3.0), rim, r);
+}
+
+void main() {
+    float d;
+    if (uShape == 0) d = sdTriangle(vLocal);
+    else if (uShape == 1) d = sdBox(vLocal, vec2(0.5));
+    else if (uSides > 0) d = sdPolygon(vLocal, 0.5, uSides);
+    else d = length(vLocal) - 0.5;
+    if (uStroke > 0.0) d = abs(d) - 0.5 * uStroke;
+
+    // One pixel of coverage ramp, whatever the instance scale
+    float aa = max(fwidth(d), 1e-5);
+    float alpha = clamp(0.5 - d / aa, 0.0, 1.0);
+    if (alpha <= 0.0) discard;
+    vec3 w = cornerWeights(vLocal);
+    FragColor = vec4(w.x * vColorTop + w.y * vColorLeft + w.z * vColorRight, alpha);
+}
+)";
+}
+
+bool SdfShapeRenderer::init() {
+    destroy();
+    GLuint p = createShaderProgram(SDF_VERTEX_SHADER, SDF_FRAGMENT_SHADER);
+    GLint linked = 0;
+    glGetProgramiv(p, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        std::cerr << "Figuras SDF no disponibles, se usan las mallas" << std::endl;
+        glDeleteProgram(p);
+        return false;
+    }
+    program = p;
+    uAspect = glGetUniformLocation(program, "uAspect");
+    uShape = glGetUniformLocation(program, "uShape");
+    uSides = glGetUniformLocation(program, "uSides");
+    uStroke = glGetUniformLocation(program, "uStroke");
+    uExtent = glGetUniformLocation(program, "uExtent");
+
+    const float corners[8] = {-1.0f, -1.0f,  1.0f, -1.0f,  -1.0f, 1.0f,  1.0f, 1.0f};
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    for (int a = 2; a <= 7; ++a) {
+        glEnableVertexAttribArray(a);
+        glVertexAttribDivisor(a, 1);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    return true;
+}
+
+void SdfShapeRenderer::destroy() {
+    if (program) glDeleteProgram(program);
+    if (vao) glDeleteVertexArrays(1, &vao);
+    if (vbo) glDeleteBuffers(1, &vbo);
+    program = vao = vbo = 0;
+}
+
+void SdfShapeRenderer::bind(int shapeType, int nSegments, float stroke, float aspect) {
+    int shape = supports(shapeType) ? shapeType : SHAPE_CIRCLE;
+    int sides = (shape == SHAPE_CIRCLE && nSegments >= 3 && nSegments <= MAX_POLYGON_SIDES) ? nSegments : 0;
+    stroke = std::max(0.0f, stroke);
+
+    glUseProgram(program);
+    glUniform1f(uAspect, aspect);
+    glUniform1i(uShape, shape);
+    glUniform1i(uSides, sides);
+    glUniform1f(uStroke, stroke);
+    // The triangle reaches 2/3 below the origin; leave room for the stroke and the AA ramp
+    glUniform1f(uExtent, 0.75f + 0.5f * stroke);
+    glBindVertexArray(vao);
+}
+
+void SdfShapeRenderer::draw(GLsizei instanceCount) {
+    if (instanceCount > 0) glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, instanceCount);
+    glBindVertexArray(0);
+}
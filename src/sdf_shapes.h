@@ -0,0 +1,38 @@
+#pragma once
+#include <GL/glew.h>
+#include "shape_types.h"
+
+// Filled shapes as signed distance fields: every instance is one quad and
+// the fragment shader evaluates the exact distance to the triangle, square,
+// circle or regular polygon of the unit mesh library, so edges are
+// anti-aliased analytically at any size (no MSAA needed) and a circle costs
+// the same 4 vertices at any segment count. A stroke width turns any shape
+// into its outline (a circle becomes a ring).
+//
+// Uses the same per-instance attributes (locations 2-7, divisor 1) as the
+// main shader and reproduces its corner color blend.
+class SdfShapeRenderer {
+public:
+    // Circles with up to this many segments are drawn as that polygon, as the mesh would
+    static const int MAX_POLYGON_SIDES = 12;
+
+    // Needs a current GL context
+    bool init();
+    void destroy();
+    bool ready() const { return program != 0; }
+
+    // Lines stay on the mesh / line renderers
+    static bool supports(int shapeType) { return shapeType == SHAPE_TRIANGLE || shapeType == SHAPE_SQUARE || shapeType == SHAPE_CIRCLE; }
+
+    // Binds program and VAO. `stroke` is the outline width in unit-shape
+    // units (0 = filled). The caller then points attributes 2-7 at its
+    // instance data and calls draw().
+    void bind(int shapeType, int nSegments, float stroke, float aspect);
+    void draw(GLsizei instanceCount);
+
+private:
+    GLuint program = 0;
+    GLuint vao = 0;
+    GLuint vbo = 0;
+    GLint uAspect = -1, uShape = -1, uSides = -1, uStroke = -1, uExtent = -1;
+};
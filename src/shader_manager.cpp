@@ -0,0 +1,279 @@
+#include "shader_manager.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <cstring>
+#include <cstdint>
+
+namespace {
+    const char MAGIC[4] = {'V', 'C', 'S', 'B'};
+    const uint32_t VERSION = 1;
+
+    struct BinaryHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t key;
+        uint32_t format;
+        uint32_t length;
+    };
+
+    uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 1469598103934665603ULL) {
+        const unsigned char* bytes = (const unsigned char*)data;
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    bool readFile(const std::string& path, std::string& out) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+        std::stringstream ss;
+        ss << in.rdbuf();
+        out = ss.str();
+        return true;
+    }
+
+    std::filesystem::file_time_type modificationTime(const std::string& path) {
+        std::error_code ec;
+        auto t = std::filesystem::last_write_time(path, ec);
+        return ec ? std::filesystem::file_time_type() : t;
+    }
+
+    GLuint startShader(GLenum type, const std::string& source) {
+        GLuint shader = glCreateShader(type);
+        const char* src = source.c_str();
+        glShaderSource(shader, 1, &src, nullptr);
+        glCompileShader(shader);
+        return shader;
+    }
+
+    void printShaderLog(GLuint shader, const char* what) {
+        GLint ok = 0;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+        if (ok) return;
+        char infoLog[1024];
+        glGetShaderInfoLog(shader, sizeof(infoLog), nullptr, infoLog);
+        std::cerr << what << " shader compilation failed:\n" << infoLog << std::endl;
+    }
+}
+
+void ShaderManager::init(const std::string& cacheDirectory) {
+    cacheDir = cacheDirectory;
+    binarySupported = GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary;
+    if (binarySupported) {
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        binarySupported = formats > 0;
+    }
+    parallelCompile = GLEW_KHR_parallel_shader_compile;
+    if (parallelCompile) glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu); // as many as the driver wants
+    const char* renderer = (const char*)glGetString(GL_RENDERER);
+    const char* version = (const char*)glGetString(GL_VERSION);
+    driverId = std::string(renderer ? renderer : "") + "|" + (version ? version : "");
+    if (binarySupported) {
+        std::error_code ec;
+        std::filesystem::create_directories(cacheDir, ec);
+    }
+}
+
+void ShaderManager::destroy() {
+    for (Entry& entry : entries) {
+        if (entry.program) glDeleteProgram(entry.program);
+        if (entry.pending) glDeleteProgram(entry.pending);
+        if (entry.pendingVertex) glDeleteShader(entry.pendingVertex);
+        if (entry.pendingFragment) glDeleteShader(entry.pendingFragment);
+    }
+    entries.clear();
+}
+
+bool ShaderManager::readSources(Entry& entry, std::string& vertex, std::string& fragment) {
+    entry.vertexTime = modificationTime(entry.vertexPath);
+    entry.fragmentTime = modificationTime(entry.fragmentPath);
+    if (!readFile(entry.vertexPath, vertex)) {
+        if (!entry.fallbackVertex) return false;
+        vertex = entry.fallbackVertex;
+    }
+    if (!readFile(entry.fragmentPath, fragment)) {
+        if (!entry.fallbackFragment) return false;
+        fragment = entry.fallbackFragment;
+    }
+    return true;
+}
+
+ShaderHandle ShaderManager::load(const std::string& name, const std::string& vertexPath, const std::string& fragmentPath,
+                                 const char* fallbackVertex, const char* fallbackFragment) {
+    Entry entry;
+    entry.name = name;
+    entry.vertexPath = vertexPath;
+    entry.fragmentPath = fragmentPath;
+    entry.fallbackVertex = fallbackVertex;
+    entry.fallbackFragment = fallbackFragment;
+
+    ShaderHandle handle;
+    std::string vertex, fragment;
+    if (!readSources(entry, vertex, fragment)) {
+        std::cerr << "Shader sin fuentes: " << name << " (" << vertexPath << ", " << fragmentPath << ")" << std::endl;
+        return handle;
+    }
+
+    // Warm start: the linked binary from a previous run with the same sources and driver
+    uint64_t key = cacheKey(vertex, fragment);
+    GLuint cached = loadBinary(entry, key);
+    if (cached) {
+        install(entry, cached, true);
+        ++binaryLoads;
+    } else {
+        compile(entry, vertex, fragment);
+        if (!finishPending(entry)) return handle;
+    }
+    handle.index = (int)entries.size();
+    entries.push_back(std::move(entry));
+    return handle;
+}
+
+void ShaderManager::compile(Entry& entry, const std::string& vertex, const std::string& fragment) {
+    // Nothing here waits on the driver; finishPending() collects the result
+    entry.pendingVertex = startShader(GL_VERTEX_SHADER, vertex);
+    entry.pendingFragment = startShader(GL_FRAGMENT_SHADER, fragment);
+    entry.pending = glCreateProgram();
+    glAttachShader(entry.pending, entry.pendingVertex);
+    glAttachShader(entry.pending, entry.pendingFragment);
+    if (binarySupported) glProgramParameteri(entry.pending, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(entry.pending);
+    entry.pendingKey = cacheKey(vertex, fragment);
+}
+
+bool ShaderManager::finishPending(Entry& entry) {
+    GLuint p = entry.pending;
+    GLint linked = 0;
+    glGetProgramiv(p, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        printShaderLog(entry.pendingVertex, "Vertex");
+        printShaderLog(entry.pendingFragment, "Fragment");
+        char infoLog[1024];
+        glGetProgramInfoLog(p, sizeof(infoLog), nullptr, infoLog);
+        std::cerr << "Shader Program linking failed (" << entry.name << "):\n" << infoLog << std::endl;
+        glDeleteProgram(p);
+    }
+    glDeleteShader(entry.pendingVertex);
+    glDeleteShader(entry.pendingFragment);
+    entry.pending = entry.pendingVertex = entry.pendingFragment = 0;
+    if (!linked) return false;
+
+    saveBinary(entry, p, entry.pendingKey);
+    install(entry, p, false);
+    return true;
+}
+
+void ShaderManager::install(Entry& entry, GLuint program, bool fromBinary) {
+    if (entry.program) glDeleteProgram(entry.program);
+    entry.program = program;
+    entry.fromBinary = fromBinary;
+    entry.uniforms.clear();
+    ++entry.generation;
+}
+
+GLuint ShaderManager::program(ShaderHandle handle) const {
+    return handle.valid() && handle.index < (int)entries.size() ? entries[handle.index].program : 0;
+}
+
+GLint ShaderManager::uniform(ShaderHandle handle, const char* name) {
+    if (!handle.valid() || handle.index >= (int)entries.size()) return -1;
+    Entry& entry = entries[handle.index];
+    auto it = entry.uniforms.find(name);
+    if (it != entry.uniforms.end()) return it->second;
+    GLint location = glGetUniformLocation(entry.program, name);
+    entry.uniforms.emplace(name, location);
+    return location;
+}
+
+unsigned ShaderManager::generation(ShaderHandle handle) const {
+    return handle.valid() && handle.index < (int)entries.size() ? entries[handle.index].generation : 0;
+}
+
+bool ShaderManager::loadedFromBinary(ShaderHandle handle) const {
+    return handle.valid() && handle.index < (int)entries.size() && entries[handle.index].fromBinary;
+}
+
+void ShaderManager::poll(double now, double interval) {
+    // Reloads started on earlier frames: swap them in once the driver is done
+    for (Entry& entry : entries) {
+        if (!entry.pending) continue;
+        GLint done = GL_TRUE;
+        if (parallelCompile) glGetProgramiv(entry.pending, GL_COMPLETION_STATUS_KHR, &done);
+        if (done && finishPending(entry)) {
+            ++reloads;
+            std::cout << "Shader recargado: " << entry.name << std::endl;
+        }
+    }
+
+    if (now - lastPoll < interval) return;
+    lastPoll = now;
+    for (Entry& entry : entries) {
+        if (entry.pending) continue;
+        if (modificationTime(entry.vertexPath) == entry.vertexTime &&
+            modificationTime(entry.fragmentPath) == entry.fragmentTime) continue;
+        std::string vertex, fragment;
+        if (!readSources(entry, vertex, fragment)) continue;
+        compile(entry, vertex, fragment);
+    }
+}
+
+uint64_t ShaderManager::cacheKey(const std::string& vertex, const std::string& fragment) const {
+    uint64_t key = fnv1a(vertex.data(), vertex.size());
+    key = fnv1a(fragment.data(), fragment.size(), key);
+    return fnv1a(driverId.data(), driverId.size(), key);
+}
+
+std::string ShaderManager::cachePath(const Entry& entry) const {
+    return cacheDir + "/" + entry.name + ".bin";
+}
+
+GLuint ShaderManager::loadBinary(const Entry& entry, uint64_t key) const {
+    if (!binarySupported) return 0;
+    std::ifstream in(cachePath(entry), std::ios::binary);
+    if (!in) return 0;
+    BinaryHeader header;
+    if (!in.read((char*)&header, sizeof(header)) || memcmp(header.magic, MAGIC, 4) != 0 ||
+        header.version != VERSION || header.key != key || header.length == 0) {
+        return 0;
+    }
+    std::vector<char> data(header.length);
+    if (!in.read(data.data(), data.size())) return 0;
+
+    GLuint p = glCreateProgram();
+    glProgramBinary(p, header.format, data.data(), (GLsizei)data.size());
+    GLint linked = 0;
+    glGetProgramiv(p, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        // The driver may reject its own older binaries; rebuild from source
+        glDeleteProgram(p);
+        return 0;
+    }
+    return p;
+}
+
+void ShaderManager::saveBinary(const Entry& entry, GLuint program, uint64_t key) const {
+    if (!binarySupported) return;
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+    std::vector<char> data(length);
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &format, data.data());
+    if (written <= 0) return;
+
+    BinaryHeader header = {};
+    memcpy(header.magic, MAGIC, 4);
+    header.version = VERSION;
+    header.key = key;
+    header.format = format;
+    header.length = (uint32_t)written;
+    std::ofstream out(cachePath(entry), std::ios::binary | std::ios::trunc);
+    if (!out) return;
+    out.write((const char*)&header, sizeof(header));
+    out.write(data.data(), written);
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <GL/glew.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <filesystem>
+
+// Index of a program in the ShaderManager
+struct ShaderHandle {
+    int index = -1;
+    bool valid() const { return index >= 0; }
+};
+
+// Shader programs loaded from files, with:
+// - cached uniform locations (cleared when the program is replaced)
+// - hot reload: poll() watches the source files; a changed pair is compiled
+//   next to the live program (in the driver's compiler threads when
+//   GL_KHR_parallel_shader_compile is available) and swapped in once linked.
+//   A reload that fails keeps the previous program.
+// - a program binary cache (glGetProgramBinary) keyed by the sources and the
+//   GL renderer/version, so warm starts skip compilation
+//
+// When a file is missing the built-in fallback source is used instead.
+class ShaderManager {
+public:
+    ~ShaderManager() { destroy(); }
+
+    // Needs a current GL context; call before load()
+    void init(const std::string& cacheDirectory = "shader_cache");
+    void destroy();
+
+    ShaderHandle load(const std::string& name, const std::string& vertexPath, const std::string& fragmentPath,
+                      const char* fallbackVertex = nullptr, const char* fallbackFragment = nullptr);
+
+    GLuint program(ShaderHandle handle) const;
+    GLint uniform(ShaderHandle handle, const char* name);
+    // Increases every time the program is replaced
+    unsigned generation(ShaderHandle handle) const;
+    bool loadedFromBinary(ShaderHandle handle) const;
+
+    // Once per frame. File timestamps are checked every `interval` seconds
+    void poll(double now, double interval = 0.5);
+
+    size_t reloadCount() const { return reloads; }
+    size_t binaryHits() const { return binaryLoads; }
+
+private:
+    struct Entry {
+        std::string name;
+        std::string vertexPath, fragmentPath;
+        const char* fallbackVertex = nullptr;
+        const char* fallbackFragment = nullptr;
+        std::filesystem::file_time_type vertexTime, fragmentTime;
+        GLuint program = 0;
+        unsigned generation = 0;
+        bool fromBinary = false;
+        std::unordered_map<std::string, GLint> uniforms;
+
+        // Reload in flight
+        GLuint pending = 0, pendingVertex = 0, pendingFragment = 0;
+        uint64_t pendingKey = 0;
+    };
+
+    bool readSources(Entry& entry, std::string& vertex, std::string& fragment);
+    void compile(Entry& entry, const std::string& vertex, const std::string& fragment);
+    bool finishPending(Entry& entry);
+    void install(Entry& entry, GLuint program, bool fromBinary);
+
+    uint64_t cacheKey(const std::string& vertex, const std::string& fragment) const;
+    std::string cachePath(const Entry& entry) const;
+    GLuint loadBinary(const Entry& entry, uint64_t key) const;
+    void saveBinary(const Entry& entry, GLuint program, uint64_t key) const;
+
+    std::vector<Entry> entries;
+    std::string cacheDir;
+    std::string driverId;               // GL_RENDERER + GL_VERSION, part of the cache key
+    bool binarySupported = false;
+    bool parallelCompile = false;
+    double lastPoll = 0.0;
+    size_t reloads = 0;
+    size_t binaryLoads = 0;
+};
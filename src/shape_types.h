@@ -0,0 +1,4 @@
+#pragma once
+
+// Base shapes, shared by the UI, presets and the mesh library
+enum ShapeType { SHAPE_TRIANGLE = 0, SHAPE_SQUARE, SHAPE_CIRCLE, SHAPE_LINE, SHAPE_LONG_LINES, SHAPE_COUNT };
@@ -0,0 +1,86 @@
+#include "smoothing.h"
+#include <cmath>
+#include <algorithm>
+
+namespace {
+    const float MIN_TAU = 1e-4f;
+    const float MAX_DT = 0.25f; // tras un bloqueo largo no saltar de golpe
+}
+
+float smoothing::expAlpha(float tau, float dt) {
+    if (dt <= 0.0f) return 0.0f;
+    if (tau <= MIN_TAU) return 1.0f;
+    return 1.0f - std::exp(-dt / tau);
+}
+
+float smoothing::tauFromPerFrameLerp(float lerpPerFrame, float refFps) {
+    if (lerpPerFrame >= 1.0f) return 0.0f;
+    if (lerpPerFrame <= 0.0f) return 1e9f;
+    return -1.0f / (refFps * std::log(1.0f - lerpPerFrame));
+}
+
+float smoothing::perFrameLerpAlpha(float lerpPerFrame, float dt, float refFps) {
+    if (lerpPerFrame >= 1.0f) return 1.0f;
+    if (lerpPerFrame <= 0.0f || dt <= 0.0f) return 0.0f;
+    return 1.0f - std::pow(1.0f - lerpPerFrame, dt * refFps);
+}
+
+int SmoothingBank::add(float initial, float attack, float release, SmoothingMode mode) {
+    current.push_back(initial);
+    target.push_back(initial);
+    velocity.push_back(0.0f);
+    attackTau.push_back(attack);
+    releaseTau.push_back(release);
+    springMix.push_back(mode == SMOOTH_SPRING ? 1.0f : 0.0f);
+    return (int)current.size() - 1;
+}
+
+void SmoothingBank::clear() {
+    current.clear();
+    target.clear();
+    velocity.clear();
+    attackTau.clear();
+    releaseTau.clear();
+    springMix.clear();
+}
+
+void SmoothingBank::snap(int slot, float value) {
+    current[slot] = value;
+    target[slot] = value;
+    velocity[slot] = 0.0f;
+}
+
+void SmoothingBank::update(float dt) {
+    dt = std::max(0.0f, std::min(MAX_DT, dt));
+    if (dt <= 0.0f) return;
+
+    const int n = size();
+    float* __restrict cur = current.data();
+    float* __restrict vel = velocity.data();
+    const float* __restrict tgt = target.data();
+    const float* __restrict att = attackTau.data();
+    const float* __restrict rel = releaseTau.data();
+    const float* __restrict mix = springMix.data();
+
+    // Both integrators are evaluated for every slot and blended by springMix,
+    // which keeps the loop free of branches so the compiler can vectorize it.
+    for (int i = 0; i < n; ++i) {
+        float tau = std::max(MIN_TAU, tgt[i] > cur[i] ? att[i] : rel[i]);
+
+        // Exponential attack / release
+        float a = 1.0f - std::exp(-dt / tau);
+        float expNext = cur[i] + (tgt[i] - cur[i]) * a;
+
+        // Critically damped spring, tau is the smoothing time
+        float omega = 2.0f / tau;
+        float x = omega * dt;
+        float decay = 1.0f / (1.0f + x + 0.48f * x * x + 0.235f * x * x * x);
+        float change = cur[i] - tgt[i];
+        float temp = (vel[i] + omega * change) * dt;
+        float springVel = (vel[i] - omega * temp) * decay;
+        float springNext = tgt[i] + (change + temp) * decay;
+
+        cur[i] = expNext + (springNext - expNext) * mix[i];
+        vel[i] = springVel * mix[i];
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+// Frame-rate independent smoothing. All time constants are in seconds, so the
+// same settings look identical at 60, 144 or 240 FPS.
+namespace smoothing {
+    // Per-step coefficient of a one-pole filter with time constant tau
+    float expAlpha(float tau, float dt);
+    // Time constant equivalent to a legacy "lerp factor per frame" at refFps
+    float tauFromPerFrameLerp(float lerpPerFrame, float refFps = 60.0f);
+    // Same legacy lerp factor, rescaled for an arbitrary dt
+    float perFrameLerpAlpha(float lerpPerFrame, float dt, float refFps = 60.0f);
+}
+
+enum SmoothingMode : uint8_t {
+    SMOOTH_EXPONENTIAL = 0, // one-pole with separate attack / release
+    SMOOTH_SPRING           // critically damped spring (no overshoot)
+};
+
+// Structure-of-arrays bank of smoothed values. Callers write targets, then a
+// single update() advances every slot in one branch-free, vectorizable loop.
+class SmoothingBank {
+public:
+    // Returns the slot index of the new value
+    int add(float initial, float attack, float release, SmoothingMode mode = SMOOTH_EXPONENTIAL);
+    void clear();
+    int size() const { return (int)current.size(); }
+
+    void update(float dt);
+
+    void setTarget(int slot, float value) { target[slot] = value; }
+    void setTimes(int slot, float attack, float release) { attackTau[slot] = attack; releaseTau[slot] = release; }
+    void setMode(int slot, SmoothingMode mode) { springMix[slot] = (mode == SMOOTH_SPRING) ? 1.0f : 0.0f; }
+    // Jump straight to a value (no transition)
+    void snap(int slot, float value);
+
+    float value(int slot) const { return current[slot]; }
+    float targetValue(int slot) const { return target[slot]; }
+
+private:
+    std::vector<float> current;
+    std::vector<float> target;
+    std::vector<float> velocity;
+    std::vector<float> attackTau;
+    std::vector<float> releaseTau;
+    std::vector<float> springMix; // 0 = exponential, 1 = spring
+};
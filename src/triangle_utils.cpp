@@ -1,28 +1,18 @@
 #include "triangle_utils.h"
 #include <vector>
 #include <cmath>
-#include <functional>
+#include <algorithm>
+#include <thread>
 
-void createShape(GLuint& VAO, GLuint& VBO, int shapeType, float size, float colorTop[3], float colorLeft[3], float colorRight[3], int nSegments) {
-    // Limpiar VAO y VBO existentes
-    if (VAO != 0) {
-        glDeleteVertexArrays(1, &VAO);
-        VAO = 0;
-    }
-    if (VBO != 0) {
-        glDeleteBuffers(1, &VBO);
-        VBO = 0;
-    }
-    
-    std::vector<float> vertices;
+void buildShapeVertices(std::vector<float>& vertices, int shapeType, float size, const float colorTop[3], const float colorLeft[3], const float colorRight[3], int nSegments) {
     float half = size / 2.0f;
     float yOffset = size / 6.0f;
     if (shapeType == 0) { // Triángulo
-        vertices = {
+        vertices.insert(vertices.end(), {
             0.0f,   size / 2.0f - yOffset, 0.0f,  colorTop[0], colorTop[1], colorTop[2],
            -half, -size / 2.0f - yOffset, 0.0f,  colorLeft[0], colorLeft[1], colorLeft[2],
             half, -size / 2.0f - yOffset, 0.0f,  colorRight[0], colorRight[1], colorRight[2]
-        };
+        });
     } else if (shapeType == 1) { // Cuadrado
         // Usa los tres colores para 3 vértices, el cuarto es promedio
         float colorBottom[3] = {
@@ -30,12 +20,12 @@ void createShape(GLuint& VAO, GLuint& VBO, int shapeType, float size, float colo
             (colorLeft[1] + colorRight[1]) / 2.0f,
             (colorLeft[2] + colorRight[2]) / 2.0f
         };
-        vertices = {
+        vertices.insert(vertices.end(), {
             -half,  half, 0.0f, colorTop[0], colorTop[1], colorTop[2], // top-left
              half,  half, 0.0f, colorTop[0], colorTop[1], colorTop[2], // top-right
             -half, -half, 0.0f, colorBottom[0], colorBottom[1], colorBottom[2], // bottom-left
              half, -half, 0.0f, colorBottom[0], colorBottom[1], colorBottom[2]  // bottom-right
-        };
+        });
     } else if (shapeType == 2) { // Círculo
         // Centro
         vertices.push_back(0.0f); vertices.push_back(0.0f); vertices.push_back(0.0f);
@@ -73,10 +63,10 @@ void createShape(GLuint& VAO, GLuint& VBO, int shapeType, float size, float colo
         }
     } else if (shapeType == 3) { // Línea
         // Línea simple horizontal
-        vertices = {
+        vertices.insert(vertices.end(), {
             -half, 0.0f, 0.0f, colorLeft[0], colorLeft[1], colorLeft[2],
              half, 0.0f, 0.0f, colorRight[0], colorRight[1], colorRight[2]
-        };
+        });
     } else if (shapeType == 4) { // Líneas largas
         // 6 líneas cruzando el origen en diferentes ángulos
         for (int i = 0; i < 6; ++i) {
@@ -90,6 +80,21 @@ void createShape(GLuint& VAO, GLuint& VBO, int shapeType, float size, float colo
             vertices.push_back(colorRight[0]); vertices.push_back(colorRight[1]); vertices.push_back(colorRight[2]);
         }
     }
+}
+
+void createShape(GLuint& VAO, GLuint& VBO, int shapeType, float size, float colorTop[3], float colorLeft[3], float colorRight[3], int nSegments) {
+    // Limpiar VAO y VBO existentes
+    if (VAO != 0) {
+        glDeleteVertexArrays(1, &VAO);
+        VAO = 0;
+    }
+    if (VBO != 0) {
+        glDeleteBuffers(1, &VBO);
+        VBO = 0;
+    }
+    
+    std::vector<float> vertices;
+    buildShapeVertices(vertices, shapeType, size, colorTop, colorLeft, colorRight, nSegments);
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
     glBindVertexArray(VAO);
@@ -103,7 +108,188 @@ void createShape(GLuint& VAO, GLuint& VBO, int shapeType, float size, float colo
     glBindVertexArray(0);
 }
 
-void createFractal(GLuint& VAO, GLuint& VBO, int baseShapeType, float size, float colorTop[3], float colorLeft[3], float colorRight[3], float depth, float time) {
+namespace {
+    const int MAX_FRACTAL_DEPTH = 8;
+    const int MAX_FRACTAL_BRANCHING = 4;
+    const int FLOATS_PER_VERTEX = 6;
+
+    int fractalBranching(int baseShapeType) {
+        return (baseShapeType == 0 || baseShapeType == 3) ? 3 : 4;
+    }
+
+    int fractalNodeVertices(int baseShapeType) {
+        switch (baseShapeType) {
+            case 0: return 3;       // triángulo
+            case 1: return 6;       // cuadrado (2 triángulos)
+            case 2: return 8 * 3;   // círculo de 8 segmentos
+            case 3: return 2;       // línea
+            case 4: return 6 * 2;   // 6 líneas
+            default: return 0;
+        }
+    }
+
+    // Child `c` of node `n` (level = levels remaining at n, counting down to 1)
+    FractalNode fractalChild(int baseShapeType, const FractalNode& n, int c, int level, float time) {
+        float scale = n.s * 0.5f;
+        FractalNode out;
+        if (baseShapeType == 0) {
+            float r = scale + sinf(time * 2.0f + level * 0.5f) * 0.1f;
+            float a = n.angle + c * 2.0944f;
+            static const float spin[3] = {0.5f, 0.7f, 0.3f};
+            out = {n.x + r * cosf(a), n.y + r * sinf(a), scale, n.angle + time * spin[c]};
+        } else if (baseShapeType == 1) {
+            static const float cx[4] = {-1.0f, 1.0f, 1.0f, -1.0f};
+            static const float cy[4] = {-1.0f, -1.0f, 1.0f, 1.0f};
+            out = {n.x + scale * cx[c], n.y + scale * cy[c], scale, n.angle + time * 0.2f * (c + 1)};
+        } else if (baseShapeType == 2) {
+            float a = c * M_PI / 2.0f + time * 0.3f;
+            out = {n.x + scale * 0.7f * cosf(a), n.y + scale * 0.7f * sinf(a), scale * 0.5f, a};
+        } else if (baseShapeType == 3) {
+            float a = n.angle + c * M_PI / 3.0f + time * 0.2f;
+            out = {n.x + scale * 0.6f * cosf(a), n.y + scale * 0.6f * sinf(a), scale * 0.4f, a};
+        } else {
+            float a = n.angle + c * M_PI / 2.0f + time * 0.3f;
+            out = {n.x + scale * 0.8f * cosf(a), n.y + scale * 0.8f * sinf(a), scale * 0.5f, a};
+        }
+        return out;
+    }
+
+    inline float* putVertex(float* v, float x, float y, float r, float g, float b) {
+        v[0] = x; v[1] = y; v[2] = 0.0f; v[3] = r; v[4] = g; v[5] = b;
+        return v + FLOATS_PER_VERTEX;
+    }
+
+    // Writes exactly fractalNodeVertices(baseShapeType) vertices for node n
+    void emitFractalNode(float* v, int baseShapeType, const FractalNode& n, int level, float time,
+                         const float colorTop[3], const float colorLeft[3], const float colorRight[3]) {
+        float scale = n.s * 0.5f;
+        // Colores animados por nivel
+        float r = std::max(0.0f, std::min(1.0f, colorTop[0] + (float)sin(time + level) * 0.3f));
+        float g = std::max(0.0f, std::min(1.0f, colorLeft[1] + (float)cos(time + level * 0.7f) * 0.3f));
+        float b = std::max(0.0f, std::min(1.0f, colorRight[2] + (float)sin(time * 1.5f + level * 0.3f) * 0.3f));
+
+        if (baseShapeType == 0) {
+            float rad = scale + sin(time * 2.0f + level * 0.5f) * 0.1f;
+            v = putVertex(v, n.x + rad * cos(n.angle), n.y + rad * sin(n.angle), r, g, b);
+            v = putVertex(v, n.x + rad * cos(n.angle + 2.0944f), n.y + rad * sin(n.angle + 2.0944f), g, b, r);
+            v = putVertex(v, n.x + rad * cos(n.angle + 4.1888f), n.y + rad * sin(n.angle + 4.1888f), b, r, g);
+        } else if (baseShapeType == 1) {
+            float x1 = n.x - scale, y1 = n.y - scale, x3 = n.x + scale, y3 = n.y + scale;
+            v = putVertex(v, x1, y1, r, g, b);
+            v = putVertex(v, x3, y1, g, b, r);
+            v = putVertex(v, x3, y3, b, r, g);
+            v = putVertex(v, x1, y1, r, g, b);
+            v = putVertex(v, x3, y3, b, r, g);
+            v = putVertex(v, x1, y3, r, g, b);
+        } else if (baseShapeType == 2) {
+            const int segments = 8;
+            for (int i = 0; i < segments; ++i) {
+                float t1 = 2.0f * M_PI * float(i) / float(segments);
+                float t2 = 2.0f * M_PI * float(i + 1) / float(segments);
+                v = putVertex(v, n.x, n.y, r, g, b);
+                v = putVertex(v, n.x + scale * cos(t1), n.y + scale * sin(t1), g, b, r);
+                v = putVertex(v, n.x + scale * cos(t2), n.y + scale * sin(t2), b, r, g);
+            }
+        } else if (baseShapeType == 3) {
+            v = putVertex(v, n.x - scale * cos(n.angle), n.y - scale * sin(n.angle), r, g, b);
+            v = putVertex(v, n.x + scale * cos(n.angle), n.y + scale * sin(n.angle), g, b, r);
+        } else if (baseShapeType == 4) {
+            for (int i = 0; i < 6; ++i) {
+                float a = n.angle + i * M_PI / 3.0f + time * 0.1f;
+                v = putVertex(v, n.x - scale * 1.5f * cos(a), n.y - scale * 1.5f * sin(a), r, g, b);
+                v = putVertex(v, n.x + scale * 1.5f * cos(a), n.y + scale * 1.5f * sin(a), g, b, r);
+            }
+        }
+    }
+
+    int clampFractalLevels(float depth) {
+        return std::max(0, std::min((int)depth, MAX_FRACTAL_DEPTH));
+    }
+}
+
+size_t fractalVertexCount(int baseShapeType, float depth) {
+    int levels = clampFractalLevels(depth);
+    size_t k = fractalBranching(baseShapeType), nodes = 0, count = 1;
+    for (int d = 0; d < levels; ++d) {
+        nodes += count;
+        count *= k;
+    }
+    return nodes * fractalNodeVertices(baseShapeType);
+}
+
+size_t buildFractalVertices(float* out, std::vector<FractalNode>& nodes, int baseShapeType, float size, const float colorTop[3], const float colorLeft[3], const float colorRight[3], float depth, float time, int threads) {
+    int levels = clampFractalLevels(depth);
+    int nodeVerts = fractalNodeVertices(baseShapeType);
+    if (levels == 0 || nodeVerts == 0) return 0;
+    const int k = fractalBranching(baseShapeType);
+
+    // Breadth-first layout: level d starts at levelStart[d] and holds k^d nodes.
+    // The parent of node i of level d is node i / k of level d - 1.
+    size_t levelStart[MAX_FRACTAL_DEPTH + 1];
+    size_t levelSize = 1, totalNodes = 0;
+    for (int d = 0; d < levels; ++d) {
+        levelStart[d] = totalNodes;
+        totalNodes += levelSize;
+        levelSize *= k;
+    }
+    levelStart[levels] = totalNodes;
+
+    // Node states, shared by the workers below (each writes its own slices).
+    // Sized for the deepest, widest tree the first time, then reused
+    if (nodes.size() < totalNodes) {
+        size_t maxNodes = 0, count = 1;
+        for (int d = 0; d < MAX_FRACTAL_DEPTH; ++d, count *= MAX_FRACTAL_BRANCHING) maxNodes += count;
+        nodes.resize(std::max(maxNodes, totalNodes));
+    }
+
+    auto emit = [&](size_t index, int d) {
+        emitFractalNode(out + index * nodeVerts * FLOATS_PER_VERTEX, baseShapeType, nodes[index], levels - d, time,
+                        colorTop, colorLeft, colorRight);
+    };
+
+    // Raíz en el centro
+    nodes[0] = {0.0f, 0.0f, size / 2.0f, time};
+    emit(0, 0);
+
+    // Each top-level subtree owns a contiguous slice of every deeper level, so
+    // subtrees can be built in parallel without sharing any output
+    auto buildSubtrees = [&](int firstChild, int lastChild) {
+        size_t slice = 1; // nodes per subtree at level d
+        for (int d = 1; d < levels; ++d, slice *= k) {
+            size_t begin = levelStart[d] + firstChild * slice;
+            size_t end = levelStart[d] + lastChild * slice;
+            for (size_t i = begin; i < end; ++i) {
+                size_t local = i - levelStart[d];
+                const FractalNode& parent = nodes[levelStart[d - 1] + local / k];
+                nodes[i] = fractalChild(baseShapeType, parent, (int)(local % k), levels - d + 1, time);
+                emit(i, d);
+            }
+        }
+    };
+
+    // Threads only pay off for large trees
+    if (threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, k);
+    if (threads <= 1 || totalNodes < 2048) {
+        buildSubtrees(0, k);
+    } else {
+        std::thread workers[4];
+        int perThread = (k + threads - 1) / threads;
+        int spawned = 0;
+        for (int c = perThread; c < k; c += perThread) {
+            workers[spawned++] = std::thread(buildSubtrees, c, std::min(k, c + perThread));
+        }
+        buildSubtrees(0, std::min(k, perThread));
+        for (int t = 0; t < spawned; ++t) workers[t].join();
+    }
+    return totalNodes * nodeVerts;
+}
+
+GLenum fractalPrimitive(int baseShapeType) {
+    return (baseShapeType == 3 || baseShapeType == 4) ? GL_LINES : GL_TRIANGLES;
+}
+
+GLsizei createFractal(GLuint& VAO, GLuint& VBO, int baseShapeType, float size, float colorTop[3], float colorLeft[3], float colorRight[3], float depth, float time) {
     // Limpiar VAO y VBO existentes
     if (VAO != 0) {
         glDeleteVertexArrays(1, &VAO);
@@ -114,193 +300,24 @@ void createFractal(GLuint& VAO, GLuint& VBO, int baseShapeType, float size, floa
         VBO = 0;
     }
     
-    std::vector<float> vertices;
-    float half = size / 2.0f;
-    
-    // Límites de seguridad para evitar demasiados vértices
-    const int MAX_VERTICES = 10000; // Máximo 10k vértices
-    const int MAX_DEPTH = 4; // Máximo 4 niveles de recursión
-    
-    int vertexCount = 0;
-    
-    // Función recursiva para generar el fractal usando std::function
-    std::function<void(float, float, float, int, float)> addFractalShape;
-    addFractalShape = [&](float x, float y, float s, int level, float angle) {
-        // Límites de seguridad
-        if (level <= 0 || level > MAX_DEPTH || vertexCount >= MAX_VERTICES) return;
-        
-        float scale = s * 0.5f;
-        float animOffset = sin(time * 2.0f + level * 0.5f) * 0.1f;
-        
-        // Colores animados por nivel
-        float r = colorTop[0] + sin(time + level) * 0.3f;
-        float g = colorLeft[1] + cos(time + level * 0.7f) * 0.3f;
-        float b = colorRight[2] + sin(time * 1.5f + level * 0.3f) * 0.3f;
-        
-        // Clamp colores
-        r = std::max(0.0f, std::min(1.0f, r));
-        g = std::max(0.0f, std::min(1.0f, g));
-        b = std::max(0.0f, std::min(1.0f, b));
-        
-        if (baseShapeType == 0) { // Triángulo fractal
-            if (vertexCount + 9 <= MAX_VERTICES) { // 3 vértices * 3 floats cada uno
-                float x1 = x + (scale + animOffset) * cos(angle);
-                float y1 = y + (scale + animOffset) * sin(angle);
-                float x2 = x + (scale + animOffset) * cos(angle + 2.0944f);
-                float y2 = y + (scale + animOffset) * sin(angle + 2.0944f);
-                float x3 = x + (scale + animOffset) * cos(angle + 4.1888f);
-                float y3 = y + (scale + animOffset) * sin(angle + 4.1888f);
-                
-                vertices.push_back(x1); vertices.push_back(y1); vertices.push_back(0.0f);
-                vertices.push_back(r); vertices.push_back(g); vertices.push_back(b);
-                vertices.push_back(x2); vertices.push_back(y2); vertices.push_back(0.0f);
-                vertices.push_back(g); vertices.push_back(b); vertices.push_back(r);
-                vertices.push_back(x3); vertices.push_back(y3); vertices.push_back(0.0f);
-                vertices.push_back(b); vertices.push_back(r); vertices.push_back(g);
-                
-                vertexCount += 9;
-                
-                // Sub-triángulos solo si no hemos alcanzado el límite
-                if (vertexCount < MAX_VERTICES) {
-                    addFractalShape(x1, y1, scale, level - 1, angle + time * 0.5f);
-                    addFractalShape(x2, y2, scale, level - 1, angle + time * 0.7f);
-                    addFractalShape(x3, y3, scale, level - 1, angle + time * 0.3f);
-                }
-            }
-            
-        } else if (baseShapeType == 1) { // Cuadrado fractal
-            if (vertexCount + 12 <= MAX_VERTICES) { // 4 vértices * 3 floats cada uno
-                float x1 = x - scale; float y1 = y - scale;
-                float x2 = x + scale; float y2 = y - scale;
-                float x3 = x + scale; float y3 = y + scale;
-                float x4 = x - scale; float y4 = y + scale;
-                
-                // Cuadrado principal
-                vertices.push_back(x1); vertices.push_back(y1); vertices.push_back(0.0f);
-                vertices.push_back(r); vertices.push_back(g); vertices.push_back(b);
-                vertices.push_back(x2); vertices.push_back(y2); vertices.push_back(0.0f);
-                vertices.push_back(g); vertices.push_back(b); vertices.push_back(r);
-                vertices.push_back(x3); vertices.push_back(y3); vertices.push_back(0.0f);
-                vertices.push_back(b); vertices.push_back(r); vertices.push_back(g);
-                vertices.push_back(x4); vertices.push_back(y4); vertices.push_back(0.0f);
-                vertices.push_back(r); vertices.push_back(g); vertices.push_back(b);
-                
-                vertexCount += 12;
-                
-                // Sub-cuadrados solo si no hemos alcanzado el límite
-                if (vertexCount < MAX_VERTICES) {
-                    addFractalShape(x1, y1, scale, level - 1, angle + time * 0.2f);
-                    addFractalShape(x2, y2, scale, level - 1, angle + time * 0.4f);
-                    addFractalShape(x3, y3, scale, level - 1, angle + time * 0.6f);
-                    addFractalShape(x4, y4, scale, level - 1, angle + time * 0.8f);
-                }
-            }
-            
-        } else if (baseShapeType == 2) { // Círculo fractal
-            int segments = 8;
-            int verticesNeeded = segments * 9; // 3 vértices por segmento * 3 floats cada uno
-            
-            if (vertexCount + verticesNeeded <= MAX_VERTICES) {
-                for (int i = 0; i < segments; ++i) {
-                    float theta1 = 2.0f * M_PI * float(i) / float(segments);
-                    float theta2 = 2.0f * M_PI * float(i + 1) / float(segments);
-                    
-                    float x1 = x + scale * cos(theta1);
-                    float y1 = y + scale * sin(theta1);
-                    float x2 = x + scale * cos(theta2);
-                    float y2 = y + scale * sin(theta2);
-                    
-                    vertices.push_back(x); vertices.push_back(y); vertices.push_back(0.0f);
-                    vertices.push_back(r); vertices.push_back(g); vertices.push_back(b);
-                    vertices.push_back(x1); vertices.push_back(y1); vertices.push_back(0.0f);
-                    vertices.push_back(g); vertices.push_back(b); vertices.push_back(r);
-                    vertices.push_back(x2); vertices.push_back(y2); vertices.push_back(0.0f);
-                    vertices.push_back(b); vertices.push_back(r); vertices.push_back(g);
-                }
-                
-                vertexCount += verticesNeeded;
-                
-                // Sub-círculos solo si no hemos alcanzado el límite
-                if (vertexCount < MAX_VERTICES) {
-                    for (int i = 0; i < 4; ++i) {
-                        float angle = i * M_PI / 2.0f + time * 0.3f;
-                        float subX = x + scale * 0.7f * cos(angle);
-                        float subY = y + scale * 0.7f * sin(angle);
-                        addFractalShape(subX, subY, scale * 0.5f, level - 1, angle);
-                    }
-                }
-            }
-        } else if (baseShapeType == 3) { // Línea fractal
-            if (vertexCount + 6 <= MAX_VERTICES) { // 2 vértices * 3 floats cada uno
-                float x1 = x - scale * cos(angle);
-                float y1 = y - scale * sin(angle);
-                float x2 = x + scale * cos(angle);
-                float y2 = y + scale * sin(angle);
-                
-                vertices.push_back(x1); vertices.push_back(y1); vertices.push_back(0.0f);
-                vertices.push_back(r); vertices.push_back(g); vertices.push_back(b);
-                vertices.push_back(x2); vertices.push_back(y2); vertices.push_back(0.0f);
-                vertices.push_back(g); vertices.push_back(b); vertices.push_back(r);
-                
-                vertexCount += 6;
-                
-                // Sub-líneas solo si no hemos alcanzado el límite
-                if (vertexCount < MAX_VERTICES) {
-                    for (int i = 0; i < 3; ++i) {
-                        float subAngle = angle + i * M_PI / 3.0f + time * 0.2f;
-                        float subX = x + scale * 0.6f * cos(subAngle);
-                        float subY = y + scale * 0.6f * sin(subAngle);
-                        addFractalShape(subX, subY, scale * 0.4f, level - 1, subAngle);
-                    }
-                }
-            }
-        } else if (baseShapeType == 4) { // Líneas largas fractal
-            if (vertexCount + 36 <= MAX_VERTICES) { // 6 líneas * 2 vértices * 3 floats cada uno
-                // 6 líneas cruzando el centro en diferentes ángulos
-                for (int i = 0; i < 6; ++i) {
-                    float lineAngle = angle + i * M_PI / 3.0f + time * 0.1f;
-                    float x1 = x - scale * 1.5f * cos(lineAngle);
-                    float y1 = y - scale * 1.5f * sin(lineAngle);
-                    float x2 = x + scale * 1.5f * cos(lineAngle);
-                    float y2 = y + scale * 1.5f * sin(lineAngle);
-                    
-                    vertices.push_back(x1); vertices.push_back(y1); vertices.push_back(0.0f);
-                    vertices.push_back(r); vertices.push_back(g); vertices.push_back(b);
-                    vertices.push_back(x2); vertices.push_back(y2); vertices.push_back(0.0f);
-                    vertices.push_back(g); vertices.push_back(b); vertices.push_back(r);
-                }
-                
-                vertexCount += 36;
-                
-                // Sub-líneas largas solo si no hemos alcanzado el límite
-                if (vertexCount < MAX_VERTICES) {
-                    for (int i = 0; i < 4; ++i) {
-                        float subAngle = angle + i * M_PI / 2.0f + time * 0.3f;
-                        float subX = x + scale * 0.8f * cos(subAngle);
-                        float subY = y + scale * 0.8f * sin(subAngle);
-                        addFractalShape(subX, subY, scale * 0.5f, level - 1, subAngle);
-                    }
-                }
-            }
-        }
-    };
-    
-    // Iniciar el fractal desde el centro con profundidad limitada
-    int actualDepth = std::min((int)depth, MAX_DEPTH);
-    addFractalShape(0.0f, 0.0f, half, actualDepth, time);
+    // Tamaño exacto conocido de antemano: un solo buffer, sin push_back
+    size_t vertexCount = fractalVertexCount(baseShapeType, depth);
+    if (vertexCount == 0) return 0;
+    thread_local std::vector<float> vertices;
+    thread_local std::vector<FractalNode> nodes;
+    vertices.resize(vertexCount * FLOATS_PER_VERTEX);
+    vertexCount = buildFractalVertices(vertices.data(), nodes, baseShapeType, size, colorTop, colorLeft, colorRight, depth, time);
     
-    // Solo crear VAO/VBO si tenemos vértices
-    if (!vertices.empty()) {
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glBindVertexArray(VAO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(float) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
-    }
-} 
\ No newline at end of file
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * vertexCount * FLOATS_PER_VERTEX, vertices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    return (GLsizei)vertexCount;
+}
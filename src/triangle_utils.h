@@ -1,5 +1,28 @@
 #pragma once
 #include <GL/glew.h>
+#include <vector>
+#include <cstddef>
+
+// Appends x,y,z,r,g,b vertices of one shape centered on the origin
+void buildShapeVertices(std::vector<float>& vertices, int shapeType, float size, const float colorTop[3], const float colorLeft[3], const float colorRight[3], int nSegments);
 
 void createShape(GLuint& VAO, GLuint& VBO, int shapeType, float size, float colorTop[3], float colorLeft[3], float colorRight[3], int nSegments = 32);
-void createFractal(GLuint& VAO, GLuint& VBO, int baseShapeType, float size, float colorTop[3], float colorLeft[3], float colorRight[3], float depth, float time); 
\ No newline at end of file
+
+// Fractal geometry on the CPU (exports, or when the GPU fractal is unavailable).
+// Levels = (int)depth, up to 8. Vertices are x,y,z,r,g,b; lines use GL_LINES.
+size_t fractalVertexCount(int baseShapeType, float depth);
+GLenum fractalPrimitive(int baseShapeType);
+
+// Position, size and orientation of one fractal node
+struct FractalNode {
+    float x, y, s, angle;
+};
+
+// Iterative breadth-first build into `out` (fractalVertexCount vertices).
+// Top-level subtrees are split across threads (threads <= 0: all cores).
+// `nodes` is caller-owned scratch: grown once to the largest tree at the
+// maximum depth and reused, so repeated builds don't allocate.
+// Returns the number of vertices written.
+size_t buildFractalVertices(float* out, std::vector<FractalNode>& nodes, int baseShapeType, float size, const float colorTop[3], const float colorLeft[3], const float colorRight[3], float depth, float time, int threads = 0);
+// Returns the vertex count to draw
+GLsizei createFractal(GLuint& VAO, GLuint& VBO, int baseShapeType, float size, float colorTop[3], float colorLeft[3], float colorRight[3], float depth, float time);
@@ -38,6 +38,9 @@ public:
         return (h + Capacity - t) & (Capacity - 1);
     }
 
+    // Usable slots (one is kept free to tell full from empty)
+    static constexpr size_t capacity() { return Capacity - 1; }
+
     // Returns true if empty
     bool empty() const { return head.load() == tail.load(); }
     // Returns true if full
@@ -0,0 +1,189 @@
+#include "visual_fractal_engine.h"
+#include <cmath>
+#include <algorithm>
+
+namespace {
+    const int FLOATS_PER_VERTEX = 6; // x,y,z + corner weights
+
+    // Unit triangle of the mesh library: top, left, right corners
+    const float BASE_TRIANGLE[3 * FLOATS_PER_VERTEX] = {
+         0.0f,  0.5f - 1.0f / 6.0f, 0.0f,  1.0f, 0.0f, 0.0f,
+        -0.5f, -0.5f - 1.0f / 6.0f, 0.0f,  0.0f, 1.0f, 0.0f,
+         0.5f, -0.5f - 1.0f / 6.0f, 0.0f,  0.0f, 0.0f, 1.0f,
+    };
+
+    // out = a + (b - a) * t, all six floats
+    inline void lerpVertex(float* out, const float* a, const float* b, float t) {
+        for (int i = 0; i < FLOATS_PER_VERTEX; ++i) out[i] = a[i] + (b[i] - a[i]) * t;
+    }
+
+    int cacheIndex(VisualFractalEngine::FractalType type) {
+        return type == VisualFractalEngine::FractalType::KOCH_SNOWFLAKE ? 1 : 0;
+    }
+}
+
+VisualFractalEngine::VisualFractalEngine()
+    : enabled(false), fractalDepth(3.0f), fractalType(FractalType::SIERPINSKI_TRIANGLE) {}
+
+VisualFractalEngine::~VisualFractalEngine() {
+    shutdown();
+}
+
+bool VisualFractalEngine::hasMesh(FractalType type) {
+    return type == FractalType::SIERPINSKI_TRIANGLE || type == FractalType::KOCH_SNOWFLAKE;
+}
+
+size_t VisualFractalEngine::levelVertices(FractalType type, int level) {
+    // Sierpinski: 3^level triangles (3^(level+1) vertices); Koch: a loop of 3 * 4^level
+    size_t n = 3;
+    for (int i = 0; i < level; ++i) n *= (type == FractalType::KOCH_SNOWFLAKE) ? 4 : 3;
+    return n;
+}
+
+bool VisualFractalEngine::initialize() {
+    shutdown();
+    // Room for every level of both types, so appending never reallocates
+    capacityVertices = 0;
+    for (int level = 0; level < MAX_DEPTH; ++level) {
+        capacityVertices += levelVertices(FractalType::SIERPINSKI_TRIANGLE, level);
+        capacityVertices += levelVertices(FractalType::KOCH_SNOWFLAKE, level);
+    }
+    usedVertices = 0;
+
+    glGenVertexArrays(1, &vertexArray);
+    glGenBuffers(1, &vertexBuffer);
+    glBindVertexArray(vertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, capacityVertices * FLOATS_PER_VERTEX * sizeof(float), nullptr, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    // Level 0 of both types is the base triangle (Koch as a closed loop)
+    for (LevelCache& cache : caches) {
+        cache.levels.clear();
+        cache.last.assign(BASE_TRIANGLE, BASE_TRIANGLE + 3 * FLOATS_PER_VERTEX);
+    }
+    appendLevel(caches[0], GL_TRIANGLES);
+    appendLevel(caches[1], GL_LINE_LOOP);
+    return vertexArray != 0 && vertexBuffer != 0;
+}
+
+void VisualFractalEngine::shutdown() {
+    if (vertexArray) glDeleteVertexArrays(1, &vertexArray);
+    if (vertexBuffer) glDeleteBuffers(1, &vertexBuffer);
+    vertexArray = 0;
+    vertexBuffer = 0;
+    usedVertices = 0;
+    for (LevelCache& cache : caches) {
+        cache.levels.clear();
+        cache.last.clear();
+    }
+}
+
+MeshRange VisualFractalEngine::appendLevel(LevelCache& cache, GLenum mode) {
+    MeshRange range;
+    range.mode = mode;
+    size_t count = cache.last.size() / FLOATS_PER_VERTEX;
+    if (usedVertices + count > capacityVertices) {
+        cache.levels.push_back(range); // empty: out of space
+        return range;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferSubData(GL_ARRAY_BUFFER, usedVertices * FLOATS_PER_VERTEX * sizeof(float),
+                    cache.last.size() * sizeof(float), cache.last.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    range.first = (GLint)usedVertices;
+    range.count = (GLsizei)count;
+    usedVertices += count;
+    cache.levels.push_back(range);
+    return range;
+}
+
+void VisualFractalEngine::generateSierpinskiTriangle(LevelCache& cache) {
+    // Each triangle keeps its three corner triangles and drops the middle one
+    const std::vector<float>& in = cache.last;
+    std::vector<float> out(in.size() * 3);
+    size_t triangles = in.size() / (3 * FLOATS_PER_VERTEX);
+    float* o = out.data();
+    for (size_t t = 0; t < triangles; ++t) {
+        const float* a = &in[t * 3 * FLOATS_PER_VERTEX];
+        const float* b = a + FLOATS_PER_VERTEX;
+        const float* c = b + FLOATS_PER_VERTEX;
+        float ab[FLOATS_PER_VERTEX], bc[FLOATS_PER_VERTEX], ca[FLOATS_PER_VERTEX];
+        lerpVertex(ab, a, b, 0.5f);
+        lerpVertex(bc, b, c, 0.5f);
+        lerpVertex(ca, c, a, 0.5f);
+        const float* corners[9] = {a, ab, ca,  ab, b, bc,  ca, bc, c};
+        for (const float* v : corners) {
+            std::copy(v, v + FLOATS_PER_VERTEX, o);
+            o += FLOATS_PER_VERTEX;
+        }
+    }
+    cache.last.swap(out);
+}
+
+void VisualFractalEngine::generateKochSnowflake(LevelCache& cache) {
+    // Each edge p->q of the counter-clockwise loop becomes p, a, peak, b with
+    // the peak pushed outwards (to the right of the edge)
+    const std::vector<float>& in = cache.last;
+    size_t n = in.size() / FLOATS_PER_VERTEX;
+    std::vector<float> out(in.size() * 4);
+    float* o = out.data();
+    const float c60 = 0.5f, s60 = -0.8660254f; // rotation by -60 degrees
+    for (size_t i = 0; i < n; ++i) {
+        const float* p = &in[i * FLOATS_PER_VERTEX];
+        const float* q = &in[((i + 1) % n) * FLOATS_PER_VERTEX];
+        float a[FLOATS_PER_VERTEX], b[FLOATS_PER_VERTEX], peak[FLOATS_PER_VERTEX];
+        lerpVertex(a, p, q, 1.0f / 3.0f);
+        lerpVertex(b, p, q, 2.0f / 3.0f);
+        lerpVertex(peak, p, q, 0.5f);
+        float dx = b[0] - a[0], dy = b[1] - a[1];
+        peak[0] = a[0] + c60 * dx - s60 * dy;
+        peak[1] = a[1] + s60 * dx + c60 * dy;
+        const float* seq[4] = {p, a, peak, b};
+        for (const float* v : seq) {
+            std::copy(v, v + FLOATS_PER_VERTEX, o);
+            o += FLOATS_PER_VERTEX;
+        }
+    }
+    cache.last.swap(out);
+}
+
+MeshRange VisualFractalEngine::levelRange(FractalType type, int depth) {
+    if (!hasMesh(type) || !vertexArray) return MeshRange();
+    int level = std::max(1, std::min((int)MAX_DEPTH, depth)) - 1;
+    LevelCache& cache = caches[cacheIndex(type)];
+    // Only the missing levels are built, each from the previous one
+    while ((int)cache.levels.size() <= level) {
+        if (type == FractalType::KOCH_SNOWFLAKE) {
+            generateKochSnowflake(cache);
+            appendLevel(cache, GL_LINE_LOOP);
+        } else {
+            generateSierpinskiTriangle(cache);
+            appendLevel(cache, GL_TRIANGLES);
+        }
+        if (cache.levels.back().count == 0) break;
+    }
+    return cache.levels[std::min(level, (int)cache.levels.size() - 1)];
+}
+
+int VisualFractalEngine::builtLevels(FractalType type) const {
+    return hasMesh(type) ? (int)caches[cacheIndex(type)].levels.size() : 0;
+}
+
+void VisualFractalEngine::update() {
+    float depth = fractalDepth + audioDepthRange * std::max(0.0f, std::min(1.0f, audioLevel));
+    currentDepth = std::max(1, std::min((int)MAX_DEPTH, (int)depth));
+    if (enabled && hasMesh(fractalType)) levelRange(fractalType, currentDepth);
+}
+
+MeshRange VisualFractalEngine::currentRange() const {
+    if (!hasMesh(fractalType)) return MeshRange();
+    const LevelCache& cache = caches[cacheIndex(fractalType)];
+    if (cache.levels.empty()) return MeshRange();
+    return cache.levels[std::min(currentDepth - 1, (int)cache.levels.size() - 1)];
+}
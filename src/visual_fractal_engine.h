@@ -1,19 +1,38 @@
 #pragma once
 
 #include <GL/glew.h>
-#include "visual_object.h"
-
-// Forward declarations
-class VisualEngine;
+#include <vector>
+#include "shape_types.h"
+#include "mesh_library.h"
 
+// Subdivision fractals (Sierpinski triangle, Koch snowflake) built one level
+// at a time: level N+1 is derived from the cached vertices of level N, so a
+// depth change (for example driven by audio) only builds the levels that are
+// missing. All levels of all types live in one preallocated GPU buffer and
+// are drawn as ranges of it. Vertices use the mesh library layout (unit
+// size, corner weights as colors), so they render with the main shader and
+// per-instance colors.
 class VisualFractalEngine {
 public:
+    // Fractal types
+    enum class FractalType {
+        SIERPINSKI_TRIANGLE,
+        KOCH_SNOWFLAKE,
+        MANDELBROT,   // fragment pass, no mesh
+        JULIA_SET,    // fragment pass, no mesh
+        CUSTOM
+    };
+
+    static const int MAX_DEPTH = 8;
+
     VisualFractalEngine();
     ~VisualFractalEngine();
     
+    // Needs a current GL context
     bool initialize();
     void shutdown();
-    void update(const VisualEngine& engine);
+    // Applies the audio-driven depth and builds any missing level
+    void update();
     
     // Fractal control
     void setEnabled(bool enabled) { this->enabled = enabled; }
@@ -21,26 +40,12 @@ public:
     
     void setDepth(float depth) { fractalDepth = depth; }
     float getDepth() const { return fractalDepth; }
-    
-    // Fractal generation
-    void generateFractal(GLuint& VAO, GLuint& VBO, ShapeType shapeType, 
-                        float size, const float* colorTop, const float* colorLeft, 
-                        const float* colorRight, float depth, float time);
-    
-    // Fractal rendering
-    void render(GLuint shaderProgram, const VisualEngine& engine, bool autoRotate, bool animateColor);
-    
-    // Fractal types
-    enum class FractalType {
-        SIERPINSKI_TRIANGLE,
-        KOCH_SNOWFLAKE,
-        MANDELBROT,
-        JULIA_SET,
-        CUSTOM
-    };
+    // Extra levels added at full audio level
+    void setAudioDepthRange(float levels) { audioDepthRange = levels; }
     
     void setFractalType(FractalType type) { fractalType = type; }
     FractalType getFractalType() const { return fractalType; }
+    static bool hasMesh(FractalType type);
     
     // Audio-reactividad
     void setAudioLevel(float level) { audioLevel = level; }
@@ -48,28 +53,45 @@ public:
     float getAudioLevel() const { return audioLevel; }
     const std::vector<float>& getAudioSpectrum() const { return audioSpectrum; }
     
+    // Fractal rendering: the VAO holds attributes 0 and 1; the caller enables
+    // and points its instance attributes
+    GLuint vao() const { return vertexArray; }
+    // Depth in use after update() (1 = base shape)
+    int getCurrentDepth() const { return currentDepth; }
+    // Range of the current type and depth; empty for types without a mesh
+    MeshRange currentRange() const;
+    // Range of one level, building it (and the levels before it) if needed
+    MeshRange levelRange(FractalType type, int depth);
+    int builtLevels(FractalType type) const;
+    
 private:
     bool enabled;
     float fractalDepth;
     FractalType fractalType;
+    float audioDepthRange = 0.0f;
+    int currentDepth = 1;
     
     float audioLevel = 0.0f;
     std::vector<float> audioSpectrum;
     
-    // Fractal generation methods
-    void generateSierpinskiTriangle(GLuint& VAO, GLuint& VBO, float size, 
-                                   const float* colors, float depth);
-    void generateKochSnowflake(GLuint& VAO, GLuint& VBO, float size, 
-                              const float* colors, float depth);
-    void generateMandelbrot(GLuint& VAO, GLuint& VBO, float size, 
-                           const float* colors, float depth, float time);
-    void generateJuliaSet(GLuint& VAO, GLuint& VBO, float size, 
-                         const float* colors, float depth, float time);
+    // Cached levels of one mesh type; `last` holds the vertices of the deepest
+    // built level, the input for the next one
+    struct LevelCache {
+        std::vector<MeshRange> levels;
+        std::vector<float> last;
+    };
+    LevelCache caches[2]; // SIERPINSKI_TRIANGLE, KOCH_SNOWFLAKE
+    
+    GLuint vertexArray = 0;
+    GLuint vertexBuffer = 0;
+    size_t capacityVertices = 0;
+    size_t usedVertices = 0;
+    
+    // Fractal generation: derive the next level from cache.last
+    void generateSierpinskiTriangle(LevelCache& cache);
+    void generateKochSnowflake(LevelCache& cache);
     
     // Helper methods
-    void createFractalVertices(std::vector<float>& vertices, 
-                              std::vector<unsigned int>& indices);
-    void applyFractalTransformation(std::vector<float>& vertices, 
-                                   const std::vector<float>& baseVertices, 
-                                   float depth);
-}; 
\ No newline at end of file
+    static size_t levelVertices(FractalType type, int level);
+    MeshRange appendLevel(LevelCache& cache, GLenum mode);
+};
@@ -0,0 +1,28 @@
+// The CPU fractal must not depend on how many threads build it: compares the
+// single-threaded output with the 4-thread one at the deepest level.
+#include "triangle_utils.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+int main() {
+    const float colorTop[3] = {1.0f, 0.2f, 0.1f};
+    const float colorLeft[3] = {0.1f, 1.0f, 0.3f};
+    const float colorRight[3] = {0.2f, 0.4f, 1.0f};
+    const char* names[5] = {"triángulo", "cuadrado", "círculo", "línea", "líneas largas"};
+    const float depth = 8.0f, time = 1.7f;
+
+    std::vector<FractalNode> nodes;
+    int failures = 0;
+    for (int shape = 0; shape < 5; ++shape) {
+        size_t floats = fractalVertexCount(shape, depth) * 6;
+        std::vector<float> single(floats, -1.0f), threaded(floats, -2.0f);
+        size_t a = buildFractalVertices(single.data(), nodes, shape, 0.8f, colorTop, colorLeft, colorRight, depth, time, 1);
+        size_t b = buildFractalVertices(threaded.data(), nodes, shape, 0.8f, colorTop, colorLeft, colorRight, depth, time, 4);
+        bool same = a == b && a * 6 == floats &&
+                    memcmp(single.data(), threaded.data(), floats * sizeof(float)) == 0;
+        printf("%-14s %8zu vértices  %s\n", names[shape], a, same ? "OK" : "DISTINTO");
+        if (!same) ++failures;
+    }
+    return failures == 0 ? 0 : 1;
+}